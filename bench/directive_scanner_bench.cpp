@@ -0,0 +1,142 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <unordered_set>
+
+#include "../src/directive_scanner.hpp"
+
+namespace rs = runsource;
+
+
+static void add_c_libs_to_link_from_file(
+        const std::filesystem::path& fle_path,
+        std::unordered_set<std::string>& libs_to_link
+)
+{
+    std::regex rgx_pragma(R"(^#pragma\ comment\(lib,.+\)$)");
+    std::regex rgx_lib(R"(\".+\")");
+    std::smatch smatch;
+    std::string curr_line;
+    std::ifstream ifs;
+    
+    ifs.open(fle_path);
+    if (ifs)
+    {
+        while ((std::getline(ifs, curr_line), !ifs.eof()))
+        {
+            if (std::regex_match(curr_line, rgx_pragma) &&
+                std::regex_search(curr_line, smatch, rgx_lib))
+            {
+                libs_to_link.insert(smatch.str());
+            }
+        }
+        
+        ifs.close();
+    }
+}
+
+
+static void write_source(const std::filesystem::path& fle_path, std::size_t n_rows)
+{
+    std::ofstream ofs(fle_path);
+    
+    ofs << "#include <cstdio>\n"
+        << "#pragma comment(lib, \"-lm\")\n"
+        << "static const unsigned tbl[] = {\n";
+    
+    for (std::size_t i = 0; i < n_rows; i++)
+    {
+        ofs << "    " << i * 2654435761u % 4294967291u << ", " << i << ", " << i * 31 << ",\n";
+    }
+    
+    ofs << "};\n"
+        << "int main() { std::printf(\"%u\\n\", tbl[0]); }\n"
+        << "#pragma comment(lib, \"-lpthread\")\n";
+}
+
+
+template<typename Fn>
+static double measure(std::size_t repeat, Fn fn)
+{
+    std::chrono::steady_clock::time_point start_tme;
+    double best_tme = 0;
+    double tme;
+    
+    for (std::size_t i = 0; i < repeat; i++)
+    {
+        start_tme = std::chrono::steady_clock::now();
+        fn();
+        tme = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme).count();
+        best_tme = i == 0 ? tme : std::min(best_tme, tme);
+    }
+    
+    return best_tme;
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::size_t n_rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::filesystem::path fle_path = std::filesystem::temp_directory_path() /
+                                     "runsource-directive-scanner-bench.cpp";
+    std::unordered_set<std::string> regex_libs;
+    std::unordered_set<std::string> scan_libs;
+    double regex_tme;
+    double scan_tme;
+    
+    write_source(fle_path, n_rows);
+    
+    regex_tme = measure(3, [&]() {
+        regex_libs.clear();
+        add_c_libs_to_link_from_file(fle_path, regex_libs);
+    });
+    
+    scan_tme = measure(3, [&]() {
+        scan_libs.clear();
+        
+        for (auto& x : rs::read_directives(fle_path))
+        {
+            if (x.typ == rs::directive_type::LINK_LIB)
+            {
+                scan_libs.insert(x.val);
+            }
+        }
+    });
+    
+    std::cout << std::filesystem::file_size(fle_path) / 1048576.0 << " MiB source" << std::endl
+              << std::fixed << std::setprecision(6)
+              << "regex:   " << regex_tme << " s, " << regex_libs.size() << " libraries"
+              << std::endl
+              << "scanner: " << scan_tme << " s, " << scan_libs.size() << " libraries"
+              << std::endl
+              << std::setprecision(1)
+              << "speedup: " << regex_tme / scan_tme << "x" << std::endl;
+    
+    std::filesystem::remove(fle_path);
+    
+    return 0;
+}
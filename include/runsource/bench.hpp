@@ -0,0 +1,233 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_BENCH_HPP
+#define RUNSOURCE_BENCH_HPP
+
+#ifndef __cplusplus
+#error "runsource/bench.hpp can only be included from C++ programs"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+
+namespace runsource {
+namespace bench {
+
+
+constexpr double min_batch_tme = 0.001;
+
+
+constexpr std::size_t n_samples = 30;
+
+
+template<typename T>
+inline void do_not_optimize(const T& val)
+{
+    asm volatile("" : : "r,m"(val) : "memory");
+}
+
+
+template<typename T>
+inline void do_not_optimize(T& val)
+{
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(val) : : "memory");
+#else
+    asm volatile("" : "+m,r"(val) : : "memory");
+#endif
+}
+
+
+inline void clobber()
+{
+    asm volatile("" : : : "memory");
+}
+
+
+struct benchmark_entry
+{
+    const char* nme;
+    
+    void (*fn)();
+};
+
+
+struct benchmark_result
+{
+    std::string nme;
+    
+    std::uint64_t iters;
+    
+    std::vector<double> tmes;
+};
+
+
+inline std::vector<benchmark_entry>& get_registry()
+{
+    static std::vector<benchmark_entry> registry;
+    
+    return registry;
+}
+
+
+class registrar
+{
+public:
+    registrar(const char* nme, void (*fn)())
+    {
+        get_registry().push_back({nme, fn});
+    }
+};
+
+
+inline double time_batch(void (*fn)(), std::uint64_t iters)
+{
+    std::chrono::steady_clock::time_point start_tme = std::chrono::steady_clock::now();
+    
+    for (std::uint64_t i = 0; i < iters; i++)
+    {
+        fn();
+        clobber();
+    }
+    
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme).count();
+}
+
+
+inline std::uint64_t calibrate(void (*fn)())
+{
+    std::uint64_t iters = 1;
+    double tme;
+    
+    while ((tme = time_batch(fn, iters)) < min_batch_tme && iters < (std::uint64_t(1) << 40))
+    {
+        iters = tme <= 0 ? iters * 10 :
+                std::min(iters * 10, std::max(iters * 2, static_cast<std::uint64_t>(
+                        iters * min_batch_tme * 1.2 / tme)));
+    }
+    
+    return iters;
+}
+
+
+inline benchmark_result run(const benchmark_entry& entry)
+{
+    benchmark_result res = {entry.nme, calibrate(entry.fn), {}};
+    
+    for (std::size_t i = 0; i < n_samples; i++)
+    {
+        res.tmes.push_back(time_batch(entry.fn, res.iters) / res.iters);
+    }
+    
+    return res;
+}
+
+
+inline bool write_all(int fd, const char* buf, std::size_t len)
+{
+    ssize_t n;
+    
+    while (len > 0)
+    {
+        n = ::write(fd, buf, len);
+        if (n <= 0)
+        {
+            return false;
+        }
+        
+        buf += n;
+        len -= n;
+    }
+    
+    return true;
+}
+
+
+inline void report(const benchmark_result& res)
+{
+    const char* fd_str = std::getenv("RUNSOURCE_BENCH_FD");
+    std::vector<double> tmes = res.tmes;
+    std::string rec;
+    std::uint32_t nme_len = static_cast<std::uint32_t>(res.nme.size());
+    std::uint32_t n_tmes = static_cast<std::uint32_t>(res.tmes.size());
+    
+    if (fd_str != nullptr)
+    {
+        rec.append(reinterpret_cast<const char*>(&nme_len), sizeof(nme_len));
+        rec.append(res.nme);
+        rec.append(reinterpret_cast<const char*>(&res.iters), sizeof(res.iters));
+        rec.append(reinterpret_cast<const char*>(&n_tmes), sizeof(n_tmes));
+        rec.append(reinterpret_cast<const char*>(res.tmes.data()), n_tmes * sizeof(double));
+        
+        if (write_all(std::atoi(fd_str), rec.data(), rec.size()))
+        {
+            return;
+        }
+    }
+    
+    std::sort(tmes.begin(), tmes.end());
+    std::printf("%-32s %14llu iterations %14.3f ns (median)\n", res.nme.c_str(),
+                static_cast<unsigned long long>(res.iters), tmes[tmes.size() / 2] * 1e9);
+}
+
+
+inline int run_all()
+{
+    for (auto& x : get_registry())
+    {
+        report(run(x));
+    }
+    
+    return 0;
+}
+
+
+}
+}
+
+
+#define RUNSOURCE_BENCH_CONCAT(lhs, rhs) lhs##rhs
+
+
+#define RUNSOURCE_BENCHMARK(nme)                                                     \
+        static void nme();                                                           \
+        static ::runsource::bench::registrar RUNSOURCE_BENCH_CONCAT(nme, _registrar)( \
+                #nme, nme);                                                          \
+        static void nme()
+
+
+#ifdef RUNSOURCE_BENCH_MAIN
+int main()
+{
+    return ::runsource::bench::run_all();
+}
+#endif
+
+
+#endif
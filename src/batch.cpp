@@ -0,0 +1,307 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "batch.hpp"
+#include "job_pool.hpp"
+#include "launcher.hpp"
+#include "memory_file.hpp"
+#include "statistics.hpp"
+
+
+namespace runsource {
+
+
+batch::batch(
+        std::vector<program> progs,
+        std::size_t jobs,
+        bool serial,
+        isolation isoltn,
+        std::size_t repeat,
+        std::size_t warmup,
+        bool monotonic_chrn
+)
+        : progs_(std::move(progs))
+        , jobs_(jobs)
+        , serial_(serial)
+        , isoltn_(std::move(isoltn))
+        , repeat_(std::max<std::size_t>(repeat, 1))
+        , warmup_(warmup)
+        , monotonic_chrn_(monotonic_chrn)
+        , args_(progs_.size())
+        , tmp_paths_(progs_.size())
+        , build_results_(progs_.size(), -1)
+        , build_tmes_(progs_.size(), 0)
+        , exit_codes_(progs_.size(), -1)
+        , run_tmes_(progs_.size(), 0)
+{
+}
+
+
+int batch::execute()
+{
+    int result;
+    std::error_code err_code;
+    std::chrono::steady_clock::time_point start_tme = std::chrono::steady_clock::now();
+    
+    if (progs_.empty())
+    {
+        std::cerr << "runsource: no source to run in the batch" << spd::ios::newl;
+        return -1;
+    }
+    
+    log_dir_ = spd::sys::fsys::get_tmp_path();
+    log_dir_ += "/runsource-";
+    log_dir_ += std::to_string(spd::sys::proc::get_pid());
+    log_dir_ += "-logs";
+    std::filesystem::create_directories(log_dir_, err_code);
+    
+    build_programs();
+    print_build_diagnostics(std::cerr);
+    run_programs();
+    
+    result = print_report(std::cout);
+    
+    std::cout << "Batch completed in "
+              << std::setprecision(3)
+              << std::fixed
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme)
+                      .count()
+              << " seconds" << spd::ios::newl;
+    
+    for (auto& x : tmp_paths_)
+    {
+        if (!x.empty())
+        {
+            remove_output_file(x);
+        }
+    }
+    
+    std::filesystem::remove(log_dir_, err_code);
+    
+    return result;
+}
+
+
+void batch::build_programs()
+{
+    job_pool pool(jobs_);
+    
+    for (std::size_t i = 0; i < progs_.size(); i++)
+    {
+        progs_[i].set_diagnostics_path(get_build_log_path(i));
+        
+        pool.push([&, i]() {
+            std::chrono::steady_clock::time_point start_tme = std::chrono::steady_clock::now();
+            
+            build_results_[i] = progs_[i].build(&args_[i], &tmp_paths_[i],
+                                                "-" + std::to_string(i));
+            build_tmes_[i] = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start_tme).count();
+            
+            return 0;
+        });
+    }
+    
+    pool.run();
+}
+
+
+void batch::print_build_diagnostics(std::ostream& os) const
+{
+    std::ifstream ifs;
+    std::error_code err_code;
+    
+    for (std::size_t i = 0; i < progs_.size(); i++)
+    {
+        ifs.open(get_build_log_path(i));
+        
+        if (ifs && ifs.peek() != std::ifstream::traits_type::eof())
+        {
+            os << "runsource: " << get_program_name(i) << ":" << spd::ios::newl << ifs.rdbuf();
+        }
+        
+        ifs.close();
+        ifs.clear();
+        std::filesystem::remove(get_build_log_path(i), err_code);
+    }
+}
+
+
+void batch::run_program(std::size_t idx)
+{
+    std::string log_path = log_dir_ + "/" + std::to_string(idx) + ".log";
+    std::string wrk_dir = progs_[idx].get_files().front().parent_path().string();
+    std::vector<double> tmes;
+    run_sample sample;
+    
+    for (std::size_t i = 0; i < warmup_ + repeat_; i++)
+    {
+        launch(args_[idx], nullptr, &sample, log_path, wrk_dir, serial_ ? &isoltn_ : nullptr);
+        
+        if (i >= warmup_)
+        {
+            tmes.push_back(monotonic_chrn_ ? sample.wall_tme : sample.cpu_tme);
+        }
+        
+        if (sample.exit_code != 0)
+        {
+            break;
+        }
+    }
+    
+    exit_codes_[idx] = sample.exit_code;
+    run_tmes_[idx] = tmes.empty() ? 0 : summarize(tmes).median;
+}
+
+
+void batch::run_programs()
+{
+    job_pool pool(serial_ ? 1 : jobs_);
+    
+    if (serial_ && !isoltn_.enter())
+    {
+        return;
+    }
+    
+    for (std::size_t i = 0; i < progs_.size(); i++)
+    {
+        if (build_results_[i] != 0)
+        {
+            continue;
+        }
+        
+        pool.push([&, i]() {
+            run_program(i);
+            return 0;
+        });
+    }
+    
+    pool.run();
+    
+    if (serial_)
+    {
+        isoltn_.leave();
+    }
+}
+
+
+int batch::print_report(std::ostream& os) const
+{
+    std::size_t n_passed = 0;
+    std::size_t n_failed = 0;
+    std::size_t n_unbuilt = 0;
+    std::string log_path;
+    std::string status;
+    std::error_code err_code;
+    std::size_t nme_wdth = 7;
+    
+    for (std::size_t i = 0; i < progs_.size(); i++)
+    {
+        nme_wdth = std::max(nme_wdth, get_program_name(i).size());
+    }
+    
+    os << spd::ios::newl
+       << std::left << std::setw(nme_wdth + 2) << "Program"
+       << std::setw(14) << "status" << std::right
+       << std::setw(12) << "build (s)"
+       << std::setw(12) << (monotonic_chrn_ ? "run (s)" : "run (CPU s)")
+       << spd::ios::newl;
+    
+    for (std::size_t i = 0; i < progs_.size(); i++)
+    {
+        log_path = log_dir_ + "/" + std::to_string(i) + ".log";
+        
+        if (build_results_[i] != 0)
+        {
+            status = "BUILD FAILED";
+            n_unbuilt++;
+        }
+        else if (exit_codes_[i] != 0)
+        {
+            status = "FAILED (" + std::to_string(exit_codes_[i]) + ")";
+            n_failed++;
+        }
+        else
+        {
+            status = "PASSED";
+            n_passed++;
+            std::filesystem::remove(log_path, err_code);
+        }
+        
+        os << std::left << std::setw(nme_wdth + 2) << get_program_name(i)
+           << std::setw(14) << status << std::right
+           << std::setprecision(3) << std::fixed
+           << std::setw(12) << build_tmes_[i];
+        
+        if (build_results_[i] == 0)
+        {
+            os << std::setprecision(6) << std::setw(12) << run_tmes_[i];
+        }
+        
+        os << spd::ios::newl;
+    }
+    
+    os << spd::ios::newl
+       << n_passed << " passed, " << n_failed << " failed, " << n_unbuilt
+       << " failed to build out of " << progs_.size() << " programs ("
+       << (serial_ ? "serial" : "parallel") << " runs";
+    
+    if (repeat_ > 1)
+    {
+        os << ", median of " << repeat_;
+    }
+    
+    os << ")" << spd::ios::newl;
+    
+    if (n_failed > 0)
+    {
+        os << "The outputs of the failed programs are kept in " << log_dir_ << spd::ios::newl;
+    }
+    
+    return n_failed + n_unbuilt == 0 ? 0 : 1;
+}
+
+
+std::string batch::get_program_name(std::size_t idx) const
+{
+    std::error_code err_code;
+    std::filesystem::path fle_path = progs_[idx].get_files().front();
+    std::filesystem::path rel_path = std::filesystem::relative(fle_path, err_code);
+    
+    return rel_path.empty() ? fle_path.string() : rel_path.string();
+}
+
+
+std::string batch::get_build_log_path(std::size_t idx) const
+{
+    return log_dir_ + "/" + std::to_string(idx) + "-build.log";
+}
+
+
+}
@@ -0,0 +1,99 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_BATCH_HPP
+#define RUNSOURCE_BATCH_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "isolation.hpp"
+#include "program.hpp"
+
+
+namespace runsource {
+
+
+class batch
+{
+public:
+    batch(
+            std::vector<program> progs,
+            std::size_t jobs,
+            bool serial,
+            isolation isoltn,
+            std::size_t repeat,
+            std::size_t warmup,
+            bool monotonic_chrn
+    );
+    
+    int execute();
+
+private:
+    void build_programs();
+    
+    void print_build_diagnostics(std::ostream& os) const;
+    
+    void run_program(std::size_t idx);
+    
+    void run_programs();
+    
+    int print_report(std::ostream& os) const;
+    
+    std::string get_program_name(std::size_t idx) const;
+    
+    std::string get_build_log_path(std::size_t idx) const;
+
+private:
+    std::vector<program> progs_;
+    
+    std::size_t jobs_;
+    
+    bool serial_;
+    
+    isolation isoltn_;
+    
+    std::size_t repeat_;
+    
+    std::size_t warmup_;
+    
+    bool monotonic_chrn_;
+    
+    std::string log_dir_;
+    
+    std::vector<std::vector<std::string>> args_;
+    
+    std::vector<std::string> tmp_paths_;
+    
+    std::vector<int> build_results_;
+    
+    std::vector<double> build_tmes_;
+    
+    std::vector<int> exit_codes_;
+    
+    std::vector<double> run_tmes_;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,199 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "bench_channel.hpp"
+#include "statistics.hpp"
+
+
+namespace runsource {
+
+
+bench_channel::bench_channel()
+        : rd_fd_(-1)
+        , wr_fd_(-1)
+        , thrd_()
+        , buf_()
+        , nmes_()
+        , results_()
+{
+}
+
+
+bench_channel::~bench_channel()
+{
+    stop(false);
+}
+
+
+bool bench_channel::start()
+{
+    int fds[2];
+    
+    if (::pipe2(fds, O_CLOEXEC) != 0)
+    {
+        std::cerr << "runsource: cannot create the benchmark pipe" << spd::ios::newl;
+        return false;
+    }
+    
+    rd_fd_ = fds[0];
+    wr_fd_ = fds[1];
+    buf_.clear();
+    
+    thrd_ = std::thread([this]() {
+        char buf[65536];
+        ssize_t len;
+        
+        while ((len = ::read(rd_fd_, buf, sizeof(buf))) != 0)
+        {
+            if (len < 0 && errno != EINTR)
+            {
+                break;
+            }
+            
+            buf_.append(buf, len > 0 ? len : 0);
+        }
+    });
+    
+    return true;
+}
+
+
+void bench_channel::stop(bool keep)
+{
+    if (wr_fd_ < 0)
+    {
+        return;
+    }
+    
+    ::close(wr_fd_);
+    wr_fd_ = -1;
+    
+    thrd_.join();
+    ::close(rd_fd_);
+    rd_fd_ = -1;
+    
+    if (keep)
+    {
+        parse_records();
+    }
+}
+
+
+int bench_channel::get_fd() const
+{
+    return wr_fd_;
+}
+
+
+void bench_channel::print_report(std::ostream& os) const
+{
+    sample_summary summ;
+    
+    if (nmes_.empty())
+    {
+        return;
+    }
+    
+    os << spd::ios::newl
+       << std::left << std::setw(32) << "Benchmark" << std::right
+       << std::setw(14) << "iterations"
+       << std::setw(14) << "min (ns)"
+       << std::setw(14) << "median (ns)"
+       << std::setw(14) << "mean (ns)"
+       << std::setw(14) << "stddev (ns)"
+       << std::setw(10) << "outliers"
+       << spd::ios::newl;
+    
+    for (auto& x : nmes_)
+    {
+        summ = summarize(results_.at(x).tmes);
+        
+        os << std::left << std::setw(32) << x << std::right
+           << std::setw(14) << results_.at(x).iters
+           << std::fixed << std::setprecision(3)
+           << std::setw(14) << summ.min * 1e9
+           << std::setw(14) << summ.median * 1e9
+           << std::setw(14) << summ.mean * 1e9
+           << std::setw(14) << summ.stddev * 1e9
+           << std::setw(10) << summ.outliers
+           << spd::ios::newl;
+    }
+}
+
+
+void bench_channel::parse_records()
+{
+    std::size_t pos = 0;
+    std::uint32_t nme_len;
+    std::uint32_t n_tmes;
+    std::uint64_t iters;
+    std::string nme;
+    double tme;
+    auto read = [&](void* dst, std::size_t len) {
+        if (buf_.size() - pos < len)
+        {
+            return false;
+        }
+        
+        std::memcpy(dst, buf_.data() + pos, len);
+        pos += len;
+        
+        return true;
+    };
+    
+    while (read(&nme_len, sizeof(nme_len)) && buf_.size() - pos >= nme_len)
+    {
+        nme.assign(buf_, pos, nme_len);
+        pos += nme_len;
+        
+        if (!read(&iters, sizeof(iters)) || !read(&n_tmes, sizeof(n_tmes)) ||
+            (buf_.size() - pos) / sizeof(double) < n_tmes)
+        {
+            break;
+        }
+        
+        if (results_.count(nme) == 0)
+        {
+            nmes_.push_back(nme);
+        }
+        
+        results_[nme].iters = iters;
+        
+        for (std::size_t i = 0; i < n_tmes && read(&tme, sizeof(tme)); i++)
+        {
+            results_[nme].tmes.push_back(tme);
+        }
+    }
+    
+    buf_.clear();
+}
+
+
+}
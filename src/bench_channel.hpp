@@ -0,0 +1,82 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_BENCH_CHANNEL_HPP
+#define RUNSOURCE_BENCH_CHANNEL_HPP
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace runsource {
+
+
+struct bench_result
+{
+    std::uint64_t iters;
+    
+    std::vector<double> tmes;
+};
+
+
+class bench_channel
+{
+public:
+    bench_channel();
+    
+    bench_channel(const bench_channel& rhs) = delete;
+    
+    ~bench_channel();
+    
+    bench_channel& operator=(const bench_channel& rhs) = delete;
+    
+    bool start();
+    
+    void stop(bool keep);
+    
+    int get_fd() const;
+    
+    void print_report(std::ostream& os) const;
+
+private:
+    void parse_records();
+
+private:
+    int rd_fd_;
+    
+    int wr_fd_;
+    
+    std::thread thrd_;
+    
+    std::string buf_;
+    
+    std::vector<std::string> nmes_;
+    
+    std::map<std::string, bench_result> results_;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,390 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "benchmark.hpp"
+#include "statistics.hpp"
+
+
+namespace runsource {
+
+
+benchmark::benchmark(
+        std::size_t repeat,
+        std::size_t warmup,
+        double precsn,
+        bool monotonic_chrn,
+        bool rsrc_usage
+)
+        : repeat_(std::max<std::size_t>(repeat, 1))
+        , warmup_(warmup)
+        , precsn_(precsn)
+        , monotonic_chrn_(monotonic_chrn)
+        , rsrc_usage_(rsrc_usage)
+        , samples_()
+{
+}
+
+
+int benchmark::run(const std::function<run_sample()>& run_fn)
+{
+    std::chrono::steady_clock::time_point start_tme;
+    double elapsed_tme;
+    
+    run_sample sample;
+    
+    samples_.clear();
+    
+    for (std::size_t i = 0; i < warmup_; i++)
+    {
+        sample = run_fn();
+        
+        if (sample.exit_code != 0)
+        {
+            samples_.push_back(std::move(sample));
+            return samples_.back().exit_code;
+        }
+    }
+    
+    start_tme = std::chrono::steady_clock::now();
+    
+    do
+    {
+        samples_.push_back(run_fn());
+        elapsed_tme = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme)
+                .count();
+    }
+    while (samples_.back().exit_code == 0 && needs_more_samples(elapsed_tme));
+    
+    return samples_.back().exit_code;
+}
+
+
+void benchmark::print_report(std::ostream& os) const
+{
+    std::stringstream strstream;
+    std::string strstream_str;
+    sample_summary wall_summ;
+    sample_summary cpu_summ;
+    auto print_row = [&](const char* nme, const sample_summary& summ) {
+        os << std::left << std::setw(6) << nme << std::right << std::setprecision(6) << std::fixed
+           << std::setw(12) << summ.min
+           << std::setw(12) << summ.median
+           << std::setw(12) << summ.mean
+           << std::setw(12) << summ.stddev
+           << std::setw(12) << summ.p90
+           << std::setw(12) << summ.p99
+           << std::setw(10) << summ.outliers
+           << spd::ios::newl;
+    };
+    
+    if (samples_.empty())
+    {
+        return;
+    }
+    
+    if (samples_.size() == 1)
+    {
+        if (monotonic_chrn_)
+        {
+            strstream << "Process exited after "
+                      << std::setprecision(3)
+                      << std::fixed
+                      << samples_.back().wall_tme
+                      << " seconds with return value " << samples_.back().exit_code;
+        }
+        else
+        {
+            strstream << "Process exited after "
+                      << std::setprecision(3)
+                      << std::fixed
+                      << samples_.back().cpu_tme
+                      << " CPU seconds with return value " << samples_.back().exit_code;
+        }
+    }
+    else
+    {
+        wall_summ = summarize(get_wall_times());
+        cpu_summ = summarize(get_cpu_times());
+        
+        strstream << "Process exited " << samples_.size() << " times after "
+                  << std::setprecision(3)
+                  << std::fixed
+                  << (monotonic_chrn_ ? wall_summ.median : cpu_summ.median)
+                  << (monotonic_chrn_ ? " seconds" : " CPU seconds")
+                  << " (median) with return value " << samples_.back().exit_code;
+        
+        if (warmup_ > 0)
+        {
+            strstream << " (" << warmup_ << " warmup runs discarded)";
+        }
+    }
+    
+    if (samples_.back().exit_code != 0 && (warmup_ > 0 || repeat_ > 1 || precsn_ > 0))
+    {
+        strstream << " (stopped at the first failing run)";
+    }
+    
+    if (samples_.back().out_captured)
+    {
+        print_output_throughput(strstream);
+    }
+    
+    strstream_str = strstream.str();
+    
+    os << spd::ios::newl;
+    for (std::size_t i = 0; i < strstream_str.size(); i++)
+    {
+        os << "-";
+    }
+    os << spd::ios::newl
+       << strstream_str
+       << spd::ios::newl;
+    
+    if (samples_.size() > 1)
+    {
+        os << std::left << std::setw(6) << "(s)" << std::right
+           << std::setw(12) << "min"
+           << std::setw(12) << "median"
+           << std::setw(12) << "mean"
+           << std::setw(12) << "stddev"
+           << std::setw(12) << "p90"
+           << std::setw(12) << "p99"
+           << std::setw(10) << "outliers"
+           << spd::ios::newl;
+        
+        print_row("wall", wall_summ);
+        print_row("cpu", cpu_summ);
+    }
+    
+    if (rsrc_usage_)
+    {
+        print_resource_usage(os);
+    }
+    
+    print_counters(os);
+}
+
+
+void benchmark::print_output_throughput(std::ostream& os) const
+{
+    double out_bytes = 0;
+    double out_lnes = 0;
+    double wall_tme = 0;
+    
+    for (auto& x : samples_)
+    {
+        out_bytes += x.out_bytes;
+        out_lnes += x.out_lnes;
+        wall_tme += x.wall_tme;
+    }
+    
+    os << ", " << std::setprecision(1) << out_bytes / samples_.size() / 1e6 << " MB";
+    
+    if (samples_.back().out_lnes >= 0)
+    {
+        os << " in " << std::setprecision(0) << out_lnes / samples_.size() << " lines";
+    }
+    
+    os << " of output at " << std::setprecision(1)
+       << (wall_tme > 0 ? out_bytes / wall_tme / 1e6 : 0) << " MB/s";
+}
+
+
+void benchmark::print_resource_usage(std::ostream& os) const
+{
+    auto print_row = [&](const char* nme, auto membr, double scale, int precsn, const char* unt) {
+        std::vector<double> vals;
+        sample_summary summ;
+        
+        for (auto& x : samples_)
+        {
+            vals.push_back(static_cast<double>(x.*membr) * scale);
+        }
+        
+        summ = summarize(vals);
+        
+        os << std::left << std::setw(22) << nme << std::right << std::setprecision(precsn)
+           << std::fixed << std::setw(14) << summ.median;
+        
+        if (samples_.size() > 1)
+        {
+            os << std::setw(14) << summ.min
+               << std::setw(14) << *std::max_element(vals.begin(), vals.end());
+        }
+        
+        os << unt << spd::ios::newl;
+    };
+    
+    os << spd::ios::newl;
+    
+    if (samples_.size() > 1)
+    {
+        os << std::left << std::setw(22) << "Resource usage" << std::right
+           << std::setw(14) << "median"
+           << std::setw(14) << "min"
+           << std::setw(14) << "max"
+           << spd::ios::newl;
+    }
+    else
+    {
+        os << "Resource usage:" << spd::ios::newl;
+    }
+    
+    print_row("user time", &run_sample::usr_tme, 1, 3, " s");
+    print_row("system time", &run_sample::sys_tme, 1, 3, " s");
+    print_row("peak RSS", &run_sample::peak_rss_kib, 1.0 / 1024, 3, " MiB");
+    print_row("minor faults", &run_sample::minor_faults, 1, 0, "");
+    print_row("major faults", &run_sample::major_faults, 1, 0, "");
+    print_row("voluntary switches", &run_sample::vol_ctx_switches, 1, 0, "");
+    print_row("involuntary switches", &run_sample::invol_ctx_switches, 1, 0, "");
+    print_row("block reads", &run_sample::blk_reads, 1, 0, "");
+    print_row("block writes", &run_sample::blk_writes, 1, 0, "");
+}
+
+
+const std::vector<run_sample>& benchmark::get_samples() const noexcept
+{
+    return samples_;
+}
+
+
+void benchmark::print_counters(std::ostream& os) const
+{
+    std::vector<std::pair<std::string, double>> countrs;
+    std::map<std::string, double> sums;
+    std::map<std::string, std::size_t> n_reads;
+    auto get_countr = [&](const char* nme) {
+        for (auto& x : countrs)
+        {
+            if (x.first == nme)
+            {
+                return x.second;
+            }
+        }
+        
+        return 0.0;
+    };
+    
+    for (auto& x : samples_)
+    {
+        for (auto& y : x.countrs)
+        {
+            if (n_reads[y.first]++ == 0)
+            {
+                countrs.emplace_back(y.first, 0);
+            }
+            
+            sums[y.first] += y.second;
+        }
+    }
+    
+    if (countrs.empty())
+    {
+        return;
+    }
+    
+    for (auto& x : countrs)
+    {
+        x.second = sums[x.first] / n_reads[x.first];
+    }
+    
+    os << spd::ios::newl
+       << (samples_.size() > 1 ? "Performance counters (mean per run):" : "Performance counters:")
+       << spd::ios::newl;
+    
+    for (auto& x : countrs)
+    {
+        os << std::left << std::setw(20) << x.first << std::right << std::setw(18)
+           << std::setprecision(0) << std::fixed << x.second;
+        
+        if (x.first == "instructions" && get_countr("cycles") > 0)
+        {
+            os << "    # " << std::setprecision(2) << x.second / get_countr("cycles")
+               << " insn per cycle";
+        }
+        else if (x.first == "cache-misses" && get_countr("cache-references") > 0)
+        {
+            os << "    # " << std::setprecision(2)
+               << 100 * x.second / get_countr("cache-references") << " % of all cache refs";
+        }
+        
+        os << spd::ios::newl;
+    }
+}
+
+
+bool benchmark::needs_more_samples(double elapsed_tme) const
+{
+    std::vector<double> tmes;
+    sample_summary summ;
+    
+    if (samples_.size() < repeat_)
+    {
+        return true;
+    }
+    
+    if (precsn_ <= 0 || samples_.size() >= max_adaptive_runs_ || elapsed_tme >= max_adaptive_tme_)
+    {
+        return false;
+    }
+    
+    tmes = monotonic_chrn_ ? get_wall_times() : get_cpu_times();
+    summ = summarize(tmes);
+    
+    return get_confidence_half_width(tmes) > precsn_ / 100 * summ.mean;
+}
+
+
+std::vector<double> benchmark::get_wall_times() const
+{
+    std::vector<double> tmes;
+    
+    for (auto& x : samples_)
+    {
+        tmes.push_back(x.wall_tme);
+    }
+    
+    return tmes;
+}
+
+
+std::vector<double> benchmark::get_cpu_times() const
+{
+    std::vector<double> tmes;
+    
+    for (auto& x : samples_)
+    {
+        tmes.push_back(x.cpu_tme);
+    }
+    
+    return tmes;
+}
+
+
+}
@@ -0,0 +1,86 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_BENCHMARK_HPP
+#define RUNSOURCE_BENCHMARK_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include "run_sample.hpp"
+
+
+namespace runsource {
+
+
+class benchmark
+{
+public:
+    benchmark(
+            std::size_t repeat,
+            std::size_t warmup,
+            double precsn,
+            bool monotonic_chrn,
+            bool rsrc_usage
+    );
+    
+    int run(const std::function<run_sample()>& run_fn);
+    
+    void print_report(std::ostream& os) const;
+    
+    const std::vector<run_sample>& get_samples() const noexcept;
+
+private:
+    void print_output_throughput(std::ostream& os) const;
+    
+    void print_resource_usage(std::ostream& os) const;
+    
+    void print_counters(std::ostream& os) const;
+    
+    bool needs_more_samples(double elapsed_tme) const;
+    
+    std::vector<double> get_wall_times() const;
+    
+    std::vector<double> get_cpu_times() const;
+
+private:
+    std::size_t repeat_;
+    
+    std::size_t warmup_;
+    
+    double precsn_;
+    
+    bool monotonic_chrn_;
+    
+    bool rsrc_usage_;
+    
+    std::vector<run_sample> samples_;
+    
+    static constexpr std::size_t max_adaptive_runs_ = 1000;
+    
+    static constexpr double max_adaptive_tme_ = 60;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,463 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "build_cache.hpp"
+#include "hasher.hpp"
+#include "warm_cache.hpp"
+
+
+namespace runsource {
+
+
+static constexpr std::chrono::seconds trim_grace_period(60);
+
+
+static bool rename_no_replace(
+        const std::filesystem::path& src_path,
+        const std::filesystem::path& dest_path
+)
+{
+    if (::renameat2(AT_FDCWD, src_path.c_str(), AT_FDCWD, dest_path.c_str(),
+                    RENAME_NOREPLACE) == 0)
+    {
+        return true;
+    }
+    
+    if (errno != EINVAL && errno != ENOSYS)
+    {
+        return false;
+    }
+    
+    return ::rename(src_path.c_str(), dest_path.c_str()) == 0;
+}
+
+
+static bool are_dependencies_up_to_date(std::istream& is)
+{
+    std::string digest;
+    std::uintmax_t sze;
+    std::filesystem::file_time_type::rep lst_write;
+    std::string path;
+    std::error_code err_code;
+    hasher hshr;
+    
+    while (is >> digest >> sze >> lst_write && std::getline(is >> std::ws, path))
+    {
+        if (std::filesystem::file_size(path, err_code) == sze && !err_code &&
+            std::filesystem::last_write_time(path, err_code).time_since_epoch().count() ==
+                    lst_write && !err_code)
+        {
+            continue;
+        }
+        
+        hshr = hasher();
+        
+        if (!hshr.update_from_file(path) || hshr.get_hex_digest() != digest)
+        {
+            return false;
+        }
+    }
+    
+    return is.eof();
+}
+
+
+build_cache::build_cache(std::filesystem::path root_path, std::uintmax_t max_sze)
+        : root_path_(std::move(root_path))
+        , max_sze_(max_sze)
+{
+}
+
+
+bool build_cache::find(const std::string& ky, std::filesystem::path* entry_path)
+{
+    std::filesystem::path path = get_entry_path(ky);
+    std::error_code err_code;
+    
+    if (!std::filesystem::is_directory(path, err_code))
+    {
+        return false;
+    }
+    
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(),
+                                     err_code);
+    
+    if (entry_path != nullptr)
+    {
+        *entry_path = std::move(path);
+    }
+    
+    return true;
+}
+
+
+bool build_cache::find_up_to_date(const std::string& ky, std::filesystem::path* entry_path)
+{
+    std::filesystem::path path;
+    std::filesystem::path mnfst_path;
+    std::string warm_ky;
+    std::string mnfst;
+    std::istringstream iss;
+    std::ifstream ifs;
+    std::error_code err_code;
+    
+    if (!find(ky, &path))
+    {
+        return false;
+    }
+    
+    mnfst_path = path / "manifest";
+    warm_ky = "manifest:" + mnfst_path.string() + ':' +
+              std::to_string(std::filesystem::file_size(mnfst_path, err_code)) + ':' +
+              std::to_string(std::filesystem::last_write_time(mnfst_path, err_code)
+                                     .time_since_epoch().count());
+    
+    if (err_code)
+    {
+        return false;
+    }
+    
+    if (!lookup_warm_value(warm_ky, &mnfst))
+    {
+        ifs.open(mnfst_path);
+        mnfst.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        
+        if (!ifs)
+        {
+            return false;
+        }
+        
+        store_warm_value(warm_ky, mnfst);
+    }
+    
+    iss.str(mnfst);
+    
+    if (!are_dependencies_up_to_date(iss))
+    {
+        return false;
+    }
+    
+    if (entry_path != nullptr)
+    {
+        *entry_path = std::move(path);
+    }
+    
+    return true;
+}
+
+
+std::filesystem::path build_cache::create_staging_directory(const std::string& ky) const
+{
+    std::filesystem::path stagng_path = root_path_ / "staging";
+    std::error_code err_code;
+    
+    stagng_path /= ky + "." + std::to_string(spd::sys::proc::get_pid());
+    std::filesystem::remove_all(stagng_path, err_code);
+    
+    if (!std::filesystem::create_directories(stagng_path, err_code))
+    {
+        return std::filesystem::path();
+    }
+    
+    return stagng_path;
+}
+
+
+bool build_cache::commit(
+        const std::string& ky,
+        const std::filesystem::path& stagng_path,
+        std::filesystem::path* entry_path
+)
+{
+    std::filesystem::path path = get_entry_path(ky);
+    std::filesystem::path stale_path = stagng_path.string() + ".stale";
+    std::error_code err_code;
+    
+    std::filesystem::create_directories(path.parent_path(), err_code);
+    
+    if (!rename_no_replace(stagng_path, path))
+    {
+        if (!std::filesystem::is_directory(path, err_code))
+        {
+            discard(stagng_path);
+            return false;
+        }
+        
+        if (is_manifest_up_to_date(path) ||
+            !rename_no_replace(path, stale_path) ||
+            !rename_no_replace(stagng_path, path))
+        {
+            discard(stagng_path);
+        }
+        
+        discard(stale_path);
+        
+        if (!std::filesystem::is_directory(path, err_code))
+        {
+            return false;
+        }
+    }
+    
+    if (entry_path != nullptr)
+    {
+        *entry_path = path;
+    }
+    
+    return true;
+}
+
+
+void build_cache::discard(const std::filesystem::path& stagng_path) const
+{
+    std::error_code err_code;
+    
+    std::filesystem::remove_all(stagng_path, err_code);
+}
+
+
+void build_cache::record_lookup(bool hit) const
+{
+    update_stats(hit ? 1 : 0, hit ? 0 : 1);
+}
+
+
+void build_cache::trim() const
+{
+    struct entry_info
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lst_use;
+        std::uintmax_t sze;
+    };
+    
+    std::vector<entry_info> entries;
+    std::uintmax_t total_sze = 0;
+    std::filesystem::file_time_type min_lst_use =
+            std::filesystem::file_time_type::clock::now() - trim_grace_period;
+    std::error_code err_code;
+    
+    for (std::filesystem::recursive_directory_iterator it(root_path_ / "entries", err_code), end;
+         !err_code && it != end;
+         it.increment(err_code))
+    {
+        if (it.depth() == 1)
+        {
+            entries.push_back({it->path(), it->last_write_time(err_code), 0});
+        }
+        else if (it.depth() > 1 && !entries.empty() && it->is_regular_file(err_code))
+        {
+            entries.back().sze += it->file_size(err_code);
+            total_sze += it->file_size(err_code);
+        }
+    }
+    
+    if (total_sze <= max_sze_)
+    {
+        return;
+    }
+    
+    std::sort(entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
+        return lhs.lst_use < rhs.lst_use;
+    });
+    
+    for (auto& x : entries)
+    {
+        if (total_sze <= max_sze_ || x.lst_use > min_lst_use)
+        {
+            break;
+        }
+        
+        std::filesystem::remove_all(x.path, err_code);
+        total_sze -= x.sze;
+    }
+}
+
+
+void build_cache::print_stats(std::ostream& os) const
+{
+    std::uintmax_t entries = 0;
+    std::uintmax_t sze = 0;
+    std::uintmax_t hits;
+    std::uintmax_t misses;
+    std::error_code err_code;
+    
+    for (std::filesystem::recursive_directory_iterator it(root_path_ / "entries", err_code), end;
+         !err_code && it != end;
+         it.increment(err_code))
+    {
+        if (it.depth() == 1)
+        {
+            entries++;
+        }
+        else if (it->is_regular_file(err_code))
+        {
+            sze += it->file_size(err_code);
+        }
+    }
+    
+    read_stats(&hits, &misses);
+    
+    os << "Cache directory: " << root_path_.string() << spd::ios::newl
+       << "Entries:         " << entries << spd::ios::newl
+       << "Size:            " << std::setprecision(1) << std::fixed
+                              << sze / 1048576.0 << " MiB of "
+                              << max_sze_ / 1048576.0 << " MiB" << spd::ios::newl
+       << "Hits:            " << hits << spd::ios::newl
+       << "Misses:          " << misses << spd::ios::newl
+       << "Hit ratio:       " << std::setprecision(1) << std::fixed
+                              << (hits + misses == 0 ? 0.0 : 100.0 * hits / (hits + misses))
+                              << " %" << spd::ios::newl;
+}
+
+
+std::filesystem::path build_cache::get_entry_path(const std::string& ky) const
+{
+    return root_path_ / "entries" / ky.substr(0, 2) / ky;
+}
+
+
+bool build_cache::write_manifest(
+        const std::filesystem::path& entry_path,
+        const std::vector<std::filesystem::path>& deps
+)
+{
+    std::ofstream ofs(entry_path / "manifest", std::ios::trunc);
+    std::error_code err_code;
+    hasher hshr;
+    
+    for (auto& x : deps)
+    {
+        hshr = hasher();
+        
+        if (!hshr.update_from_file(x))
+        {
+            return false;
+        }
+        
+        ofs << hshr.get_hex_digest() << ' '
+            << std::filesystem::file_size(x, err_code) << ' '
+            << std::filesystem::last_write_time(x, err_code).time_since_epoch().count() << ' '
+            << x.string() << spd::ios::newl;
+    }
+    
+    return static_cast<bool>(ofs);
+}
+
+
+bool build_cache::read_manifest(
+        const std::filesystem::path& entry_path,
+        std::vector<std::filesystem::path>* deps
+)
+{
+    std::ifstream ifs(entry_path / "manifest");
+    std::string digest;
+    std::uintmax_t sze;
+    std::filesystem::file_time_type::rep lst_write;
+    std::string path;
+    
+    if (!ifs)
+    {
+        return false;
+    }
+    
+    deps->clear();
+    
+    while (ifs >> digest >> sze >> lst_write && std::getline(ifs >> std::ws, path))
+    {
+        deps->emplace_back(path);
+    }
+    
+    return ifs.eof();
+}
+
+
+bool build_cache::is_manifest_up_to_date(const std::filesystem::path& entry_path)
+{
+    std::ifstream ifs(entry_path / "manifest");
+    
+    return ifs && are_dependencies_up_to_date(ifs);
+}
+
+
+void build_cache::read_stats(std::uintmax_t* hits, std::uintmax_t* misses) const
+{
+    std::ifstream ifs(root_path_ / "stats");
+    
+    *hits = 0;
+    *misses = 0;
+    
+    if (ifs)
+    {
+        ifs >> *hits >> *misses;
+    }
+}
+
+
+void build_cache::update_stats(std::uintmax_t hits_inc, std::uintmax_t misses_inc) const
+{
+    std::uintmax_t hits;
+    std::uintmax_t misses;
+    std::error_code err_code;
+    std::ofstream ofs;
+    int lck_fd;
+    
+    std::filesystem::create_directories(root_path_, err_code);
+    
+    lck_fd = ::open((root_path_ / "stats.lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lck_fd < 0)
+    {
+        return;
+    }
+    
+    if (::flock(lck_fd, LOCK_EX) == 0)
+    {
+        read_stats(&hits, &misses);
+        
+        ofs.open(root_path_ / "stats.tmp", std::ios::trunc);
+        ofs << hits + hits_inc << ' ' << misses + misses_inc << spd::ios::newl;
+        ofs.close();
+        
+        if (ofs)
+        {
+            std::filesystem::rename(root_path_ / "stats.tmp", root_path_ / "stats", err_code);
+        }
+    }
+    
+    ::close(lck_fd);
+}
+
+
+}
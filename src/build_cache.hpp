@@ -0,0 +1,87 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_BUILD_CACHE_HPP
+#define RUNSOURCE_BUILD_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace runsource {
+
+
+class build_cache
+{
+public:
+    build_cache(std::filesystem::path root_path, std::uintmax_t max_sze);
+    
+    bool find(const std::string& ky, std::filesystem::path* entry_path);
+    
+    bool find_up_to_date(const std::string& ky, std::filesystem::path* entry_path);
+    
+    std::filesystem::path create_staging_directory(const std::string& ky) const;
+    
+    bool commit(
+            const std::string& ky,
+            const std::filesystem::path& stagng_path,
+            std::filesystem::path* entry_path
+    );
+    
+    void discard(const std::filesystem::path& stagng_path) const;
+    
+    void record_lookup(bool hit) const;
+    
+    void trim() const;
+    
+    void print_stats(std::ostream& os) const;
+    
+    static bool write_manifest(
+            const std::filesystem::path& entry_path,
+            const std::vector<std::filesystem::path>& deps
+    );
+    
+    static bool read_manifest(
+            const std::filesystem::path& entry_path,
+            std::vector<std::filesystem::path>* deps
+    );
+    
+    static bool is_manifest_up_to_date(const std::filesystem::path& entry_path);
+
+private:
+    std::filesystem::path get_entry_path(const std::string& ky) const;
+    
+    void read_stats(std::uintmax_t* hits, std::uintmax_t* misses) const;
+    
+    void update_stats(std::uintmax_t hits_inc, std::uintmax_t misses_inc) const;
+
+private:
+    std::filesystem::path root_path_;
+    
+    std::uintmax_t max_sze_;
+};
+
+
+}
+
+
+#endif
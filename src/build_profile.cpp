@@ -0,0 +1,333 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "build_profile.hpp"
+
+
+namespace runsource {
+
+
+static bool parse_time_report_line(const std::string& line, std::string* nme, double* wall_tme)
+{
+    std::string vals;
+    std::stringstream strstream;
+    double usr_tme;
+    double sys_tme;
+    std::size_t pos = line.find(':');
+    std::size_t beg;
+    std::size_t end;
+    
+    if (pos == std::string::npos || line.empty() || line.front() != ' ')
+    {
+        return false;
+    }
+    
+    beg = line.find_first_not_of(" ");
+    end = line.find_last_not_of(" ", pos - 1);
+    if (beg >= pos || end == std::string::npos)
+    {
+        return false;
+    }
+    
+    *nme = line.substr(beg, end - beg + 1);
+    
+    for (auto i = pos + 1; i < line.size(); i++)
+    {
+        if (line[i] == '(')
+        {
+            i = line.find(')', i);
+            if (i == std::string::npos)
+            {
+                break;
+            }
+            
+            vals += ' ';
+        }
+        else
+        {
+            vals += line[i];
+        }
+    }
+    
+    strstream.str(vals);
+    
+    return static_cast<bool>(strstream >> usr_tme >> sys_tme >> *wall_tme);
+}
+
+
+static std::string get_json_string(const std::string& json, const std::string& ky)
+{
+    std::string val;
+    std::size_t pos = json.find("\"" + ky + "\":\"");
+    
+    if (pos == std::string::npos)
+    {
+        return val;
+    }
+    
+    for (pos += ky.size() + 4; pos < json.size() && json[pos] != '"'; pos++)
+    {
+        if (json[pos] == '\\' && pos + 1 < json.size())
+        {
+            pos++;
+        }
+        
+        val += json[pos];
+    }
+    
+    return val;
+}
+
+
+static double get_json_number(const std::string& json, const std::string& ky)
+{
+    std::size_t pos = json.find("\"" + ky + "\":");
+    
+    return pos == std::string::npos ? 0 : std::strtod(json.c_str() + pos + ky.size() + 3, nullptr);
+}
+
+
+void build_profile::add_time_report(const std::filesystem::path& report_path, std::ostream& diag_os)
+{
+    std::map<std::string, double> tmes;
+    std::string curr_line;
+    std::string nme;
+    double tme;
+    double codegen_tme = 0;
+    bool in_codegen = false;
+    bool in_report = false;
+    std::ifstream ifs(report_path);
+    
+    while (std::getline(ifs, curr_line))
+    {
+        if (curr_line.compare(0, 13, "Time variable") == 0)
+        {
+            in_report = true;
+            continue;
+        }
+        
+        if (!in_report)
+        {
+            if (!curr_line.empty())
+            {
+                diag_os << curr_line << spd::ios::newl;
+            }
+            
+            continue;
+        }
+        
+        if (!parse_time_report_line(curr_line, &nme, &tme))
+        {
+            continue;
+        }
+        
+        in_codegen = in_codegen || nme == "expand vars" || nme == "expand";
+        
+        if (in_codegen && nme != "TOTAL")
+        {
+            codegen_tme += tme;
+        }
+        
+        tmes[nme] = tme;
+    }
+    
+    if (tmes.empty())
+    {
+        return;
+    }
+    
+    add_phase_time("preprocess", tmes["preprocessing"]);
+    add_phase_time("template instantiation", tmes["template instantiation"]);
+    add_phase_time("parse", std::max(tmes["phase setup"] + tmes["phase parsing"] +
+                                     tmes["phase lang. deferred"] - tmes["preprocessing"] -
+                                     tmes["template instantiation"], 0.0));
+    add_phase_time("optimization", std::max(tmes["phase opt and generate"] - codegen_tme, 0.0));
+    add_phase_time("codegen", codegen_tme + tmes["phase last asm"]);
+}
+
+
+void build_profile::add_time_trace(const std::filesystem::path& trace_path)
+{
+    std::map<std::string, double> tmes;
+    std::stringstream strstream;
+    std::string json;
+    std::string evnt;
+    std::string nme;
+    std::string detl;
+    std::size_t pos;
+    std::size_t end_pos;
+    double tme;
+    std::ifstream ifs(trace_path);
+    
+    strstream << ifs.rdbuf();
+    json = strstream.str();
+    
+    for (pos = json.find("{\"pid\":"); pos != std::string::npos; pos = end_pos)
+    {
+        end_pos = json.find("{\"pid\":", pos + 1);
+        evnt = json.substr(pos, end_pos == std::string::npos ? end_pos : end_pos - pos);
+        nme = get_json_string(evnt, "name");
+        detl = get_json_string(evnt, "detail");
+        tme = get_json_number(evnt, "dur") / 1e6;
+        
+        if (nme.compare(0, 6, "Total ") == 0)
+        {
+            tmes[nme.substr(6)] += tme;
+        }
+        else if (nme == "Source" && !detl.empty())
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            hdr_costs_[detl] += tme;
+        }
+        else if ((nme == "InstantiateClass" || nme == "InstantiateFunction") && !detl.empty())
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            tmplt_costs_[detl] += tme;
+        }
+    }
+    
+    if (tmes.empty())
+    {
+        return;
+    }
+    
+    tme = tmes["PerformPendingInstantiations"] + tmes["InstantiateClass"];
+    add_phase_time("template instantiation", tme);
+    add_phase_time("parse", std::max(tmes["Frontend"] - tme, 0.0));
+    add_phase_time("optimization", tmes.count("Optimizer") != 0 ? tmes["Optimizer"] :
+                                   tmes["OptModule"] + tmes["OptFunction"]);
+    add_phase_time("codegen", tmes.count("CodeGenPasses") != 0 ? tmes["CodeGenPasses"] :
+                              tmes["CodeGen Function"]);
+}
+
+
+void build_profile::add_link_time(double tme)
+{
+    add_phase_time("link", tme);
+}
+
+
+void build_profile::add_header_cost(const std::string& hdr_nme, double tme)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    hdr_costs_[hdr_nme] += tme;
+}
+
+
+bool build_profile::has_header_costs() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    
+    return !hdr_costs_.empty();
+}
+
+
+void build_profile::print(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    double totl_tme = 0;
+    
+    for (auto& x : phase_tmes_)
+    {
+        totl_tme += x.second;
+    }
+    
+    os << spd::ios::newl << "Build profile (wall seconds):" << spd::ios::newl;
+    
+    for (auto& x : phase_nmes_)
+    {
+        if (phase_tmes_.count(x) == 0)
+        {
+            continue;
+        }
+        
+        os << "  " << std::left << std::setw(28) << x << std::right
+           << std::setprecision(3) << std::fixed
+           << std::setw(10) << phase_tmes_.at(x)
+           << std::setprecision(1)
+           << std::setw(8) << (totl_tme > 0 ? phase_tmes_.at(x) * 100 / totl_tme : 0) << '%'
+           << spd::ios::newl;
+    }
+    
+    os << "  " << std::left << std::setw(28) << "total" << std::right
+       << std::setprecision(3) << std::fixed
+       << std::setw(10) << totl_tme << spd::ios::newl;
+    
+    if (!hdr_costs_.empty())
+    {
+        os << spd::ios::newl << "Most expensive headers:" << spd::ios::newl;
+        print_ranking(os, hdr_costs_, 10);
+    }
+    
+    if (!tmplt_costs_.empty())
+    {
+        os << spd::ios::newl << "Most expensive templates:" << spd::ios::newl;
+        print_ranking(os, tmplt_costs_, 10);
+    }
+}
+
+
+void build_profile::add_phase_time(const std::string& phase_nme, double tme)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    phase_tmes_[phase_nme] += tme;
+}
+
+
+void build_profile::print_ranking(
+        std::ostream& os,
+        const std::map<std::string, double>& costs,
+        std::size_t max_entries
+)
+{
+    std::vector<std::pair<std::string, double>> rankng(costs.begin(), costs.end());
+    std::string nme;
+    
+    std::sort(rankng.begin(), rankng.end(), [](auto& lhs, auto& rhs) {
+        return lhs.second > rhs.second;
+    });
+    
+    if (rankng.size() > max_entries)
+    {
+        rankng.resize(max_entries);
+    }
+    
+    for (auto& x : rankng)
+    {
+        nme = x.first.size() > 64 ? x.first.substr(0, 61) + "..." : x.first;
+        
+        os << "  " << std::left << std::setw(66) << nme << std::right
+           << std::setprecision(3) << std::fixed
+           << std::setw(10) << x.second << spd::ios::newl;
+    }
+}
+
+
+}
@@ -0,0 +1,86 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_BUILD_PROFILE_HPP
+#define RUNSOURCE_BUILD_PROFILE_HPP
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+
+namespace runsource {
+
+
+class build_profile
+{
+public:
+    build_profile() = default;
+    
+    build_profile(const build_profile& rhs) = delete;
+    
+    build_profile& operator=(const build_profile& rhs) = delete;
+    
+    void add_time_report(const std::filesystem::path& report_path, std::ostream& diag_os);
+    
+    void add_time_trace(const std::filesystem::path& trace_path);
+    
+    void add_link_time(double tme);
+    
+    void add_header_cost(const std::string& hdr_nme, double tme);
+    
+    bool has_header_costs() const;
+    
+    void print(std::ostream& os) const;
+
+private:
+    void add_phase_time(const std::string& phase_nme, double tme);
+    
+    static void print_ranking(
+            std::ostream& os,
+            const std::map<std::string, double>& costs,
+            std::size_t max_entries
+    );
+
+private:
+    std::map<std::string, double> phase_tmes_;
+    
+    std::map<std::string, double> hdr_costs_;
+    
+    std::map<std::string, double> tmplt_costs_;
+    
+    mutable std::mutex mtx_;
+    
+    static constexpr const char* phase_nmes_[] = {
+            "preprocess",
+            "parse",
+            "template instantiation",
+            "optimization",
+            "codegen",
+            "link",
+    };
+};
+
+
+}
+
+
+#endif
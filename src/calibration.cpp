@@ -0,0 +1,166 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+#include <time.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "calibration.hpp"
+#include "launcher.hpp"
+#include "output_capture.hpp"
+#include "statistics.hpp"
+
+
+namespace runsource {
+
+
+static constexpr std::size_t baseline_warmup = 3;
+
+
+static constexpr std::size_t baseline_runs = 30;
+
+
+static constexpr std::size_t timer_calls = 100000;
+
+
+bool measure_startup_baseline(
+        const std::vector<std::string>& args,
+        const isolation* isoltn,
+        const std::string& capt,
+        startup_baseline* basln
+)
+{
+    std::vector<double> wall_tmes;
+    std::vector<double> cpu_tmes;
+    output_capture captr(capt);
+    run_sample sample;
+    
+    for (std::size_t i = 0; i < baseline_warmup + baseline_runs; i++)
+    {
+        if (!captr.start())
+        {
+            return false;
+        }
+        
+        launch(args, nullptr, &sample, captr.get_out_path(), std::string(), isoltn);
+        captr.stop(&sample);
+        
+        if (sample.exit_code != 0)
+        {
+            return false;
+        }
+        
+        if (i >= baseline_warmup)
+        {
+            wall_tmes.push_back(sample.wall_tme);
+            cpu_tmes.push_back(sample.cpu_tme);
+        }
+    }
+    
+    basln->wall_tme = summarize(wall_tmes).median;
+    basln->cpu_tme = summarize(cpu_tmes).median;
+    basln->runs = baseline_runs;
+    
+    return true;
+}
+
+
+bool read_startup_baseline(const std::filesystem::path& basln_path, startup_baseline* basln)
+{
+    std::ifstream ifs(basln_path);
+    
+    return static_cast<bool>(ifs >> basln->wall_tme >> basln->cpu_tme >> basln->runs);
+}
+
+
+bool write_startup_baseline(const std::filesystem::path& basln_path, const startup_baseline& basln)
+{
+    std::error_code err_code;
+    std::ofstream ofs;
+    
+    std::filesystem::create_directories(basln_path.parent_path(), err_code);
+    ofs.open(basln_path, std::ios::trunc);
+    ofs << std::setprecision(9) << basln.wall_tme << ' ' << basln.cpu_tme << ' ' << basln.runs
+        << '\n';
+    
+    return static_cast<bool>(ofs);
+}
+
+
+double get_clock_resolution()
+{
+    timespec res;
+    
+    if (::clock_getres(CLOCK_MONOTONIC, &res) != 0)
+    {
+        return 0;
+    }
+    
+    return res.tv_sec + res.tv_nsec / 1e9;
+}
+
+
+double measure_timer_overhead()
+{
+    std::chrono::steady_clock::time_point start_tme = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point tme = start_tme;
+    
+    for (std::size_t i = 0; i < timer_calls; i++)
+    {
+        tme = std::chrono::steady_clock::now();
+    }
+    
+    return std::chrono::duration<double>(tme - start_tme).count() / timer_calls;
+}
+
+
+void print_calibration(
+        std::ostream& os,
+        const startup_baseline& basln,
+        const std::vector<double>& tmes,
+        bool monotonic_chrn
+)
+{
+    double basln_tme = monotonic_chrn ? basln.wall_tme : basln.cpu_tme;
+    sample_summary summ;
+    std::vector<double> adj_tmes;
+    
+    for (auto& x : tmes)
+    {
+        adj_tmes.push_back(x - basln_tme);
+    }
+    
+    summ = summarize(adj_tmes);
+    
+    os << "Startup baseline " << std::fixed << std::setprecision(6) << basln_tme
+       << (monotonic_chrn ? " seconds" : " CPU seconds") << " (median of " << basln.runs
+       << " empty runs), adjusted median " << summ.median << ", mean " << summ.mean
+       << spd::ios::newl
+       << "Clock resolution " << std::setprecision(0) << get_clock_resolution() * 1e9
+       << " ns, timer overhead " << std::setprecision(1) << measure_timer_overhead() * 1e9
+       << " ns" << spd::ios::newl;
+}
+
+
+}
@@ -0,0 +1,75 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_CALIBRATION_HPP
+#define RUNSOURCE_CALIBRATION_HPP
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "isolation.hpp"
+
+
+namespace runsource {
+
+
+struct startup_baseline
+{
+    double wall_tme;
+    
+    double cpu_tme;
+    
+    std::size_t runs;
+};
+
+
+bool measure_startup_baseline(
+        const std::vector<std::string>& args,
+        const isolation* isoltn,
+        const std::string& capt,
+        startup_baseline* basln
+);
+
+
+bool read_startup_baseline(const std::filesystem::path& basln_path, startup_baseline* basln);
+
+
+bool write_startup_baseline(const std::filesystem::path& basln_path, const startup_baseline& basln);
+
+
+double get_clock_resolution();
+
+
+double measure_timer_overhead();
+
+
+void print_calibration(
+        std::ostream& os,
+        const startup_baseline& basln,
+        const std::vector<double>& tmes,
+        bool monotonic_chrn
+);
+
+
+}
+
+
+#endif
@@ -0,0 +1,578 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "daemon.hpp"
+#include "warm_cache.hpp"
+
+extern char** environ;
+
+
+namespace runsource {
+
+
+static constexpr std::size_t warm_cache_sze = 64u << 20;
+
+
+static volatile std::sig_atomic_t wrkr_pid = 0;
+
+
+static volatile std::sig_atomic_t fwd_sig = 0;
+
+
+static int reply_fd = -1;
+
+
+static void forward_signal(int sig)
+{
+    fwd_sig = sig;
+    
+    if (wrkr_pid > 0)
+    {
+        ::kill(-wrkr_pid, sig);
+    }
+}
+
+
+static void reply_exit_status(int status, void*)
+{
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    
+    if (reply_fd >= 0)
+    {
+        ::send(reply_fd, &status, sizeof(status), MSG_NOSIGNAL);
+    }
+}
+
+
+static bool get_socket_address(const std::filesystem::path& sock_path, sockaddr_un* addr)
+{
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    
+    if (sock_path.string().size() >= sizeof(addr->sun_path))
+    {
+        return false;
+    }
+    
+    std::strcpy(addr->sun_path, sock_path.c_str());
+    
+    return true;
+}
+
+
+static bool write_all(int fd, const void* buf, std::size_t sze)
+{
+    const char* cur = static_cast<const char*>(buf);
+    ssize_t n;
+    
+    while (sze > 0)
+    {
+        n = ::write(fd, cur, sze);
+        
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        
+        if (n <= 0)
+        {
+            return false;
+        }
+        
+        cur += n;
+        sze -= n;
+    }
+    
+    return true;
+}
+
+
+static bool read_all(int fd, void* buf, std::size_t sze)
+{
+    char* cur = static_cast<char*>(buf);
+    ssize_t n;
+    
+    while (sze > 0)
+    {
+        n = ::read(fd, cur, sze);
+        
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        
+        if (n <= 0)
+        {
+            return false;
+        }
+        
+        cur += n;
+        sze -= n;
+    }
+    
+    return true;
+}
+
+
+static int connect_to(const std::filesystem::path& sock_path)
+{
+    sockaddr_un addr;
+    int fd;
+    
+    if (!get_socket_address(sock_path, &addr))
+    {
+        return -1;
+    }
+    
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+
+static bool receive_header(int fd, message_header* hdr, int* std_fds)
+{
+    char ctrl[CMSG_SPACE(3 * sizeof(int))];
+    iovec iov = {hdr, sizeof(*hdr)};
+    msghdr msg = {};
+    cmsghdr* cmsg;
+    ssize_t n;
+    
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    
+    do
+    {
+        n = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != nullptr && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(3 * sizeof(int)))
+    {
+        std::memcpy(std_fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+    }
+    
+    if (n <= 0 || !read_all(fd, reinterpret_cast<char*>(hdr) + n, sizeof(*hdr) - n))
+    {
+        return false;
+    }
+    
+    return hdr->kind != message_kind::RUN || std_fds[0] >= 0;
+}
+
+
+static bool receive_request(
+        int fd,
+        const message_header& hdr,
+        std::string* cwd,
+        std::vector<std::string>* args,
+        std::vector<std::string>* envs
+)
+{
+    std::string payld;
+    std::size_t pos;
+    std::size_t end_pos;
+    
+    if (hdr.sze > (64u << 20))
+    {
+        return false;
+    }
+    
+    payld.resize(hdr.sze);
+    if (!read_all(fd, payld.data(), payld.size()))
+    {
+        return false;
+    }
+    
+    for (pos = 0; pos < payld.size(); pos = end_pos + 1)
+    {
+        end_pos = payld.find('\0', pos);
+        if (end_pos == std::string::npos)
+        {
+            return false;
+        }
+        
+        if (cwd->empty())
+        {
+            cwd->assign(payld, pos, end_pos - pos);
+        }
+        else if (args->size() < hdr.n_args)
+        {
+            args->emplace_back(payld, pos, end_pos - pos);
+        }
+        else
+        {
+            envs->emplace_back(payld, pos, end_pos - pos);
+        }
+    }
+    
+    return !cwd->empty() && args->size() == hdr.n_args && hdr.n_args > 0;
+}
+
+
+static int handle_request(
+        int fd,
+        const message_header& hdr,
+        int* std_fds,
+        const std::function<int(int, char*[])>& handlr
+)
+{
+    int res = -1;
+    pid_t pid = ::getpid();
+    std::string cwd;
+    std::vector<std::string> args;
+    std::vector<std::string> envs;
+    std::vector<char*> argv;
+    
+    if (!receive_request(fd, hdr, &cwd, &args, &envs) || !write_all(fd, &pid, sizeof(pid)))
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            ::close(std_fds[i]);
+        }
+        
+        return -1;
+    }
+    
+    for (int i = 0; i < 3; i++)
+    {
+        ::dup2(std_fds[i], i);
+        ::close(std_fds[i]);
+    }
+    
+    ::clearenv();
+    
+    for (auto& x : envs)
+    {
+        std::size_t pos = x.find('=');
+        
+        if (pos != std::string::npos)
+        {
+            ::setenv(x.substr(0, pos).c_str(), x.c_str() + pos + 1, 1);
+        }
+    }
+    
+    for (auto& x : args)
+    {
+        argv.push_back(x.data());
+    }
+    
+    argv.push_back(nullptr);
+    reply_fd = fd;
+    ::on_exit(reply_exit_status, nullptr);
+    
+    if (::chdir(cwd.c_str()) == 0)
+    {
+        res = handlr(static_cast<int>(args.size()), argv.data());
+    }
+    else
+    {
+        std::cerr << "runsource: cannot change directory to " << cwd << spd::ios::newl;
+    }
+    
+    std::cout.flush();
+    std::cerr.flush();
+    
+    write_all(fd, &res, sizeof(res));
+    
+    return 0;
+}
+
+
+bool forward_request(const std::filesystem::path& sock_path, int argc, char* argv[], int* res)
+{
+    std::error_code err_code;
+    std::string payld = std::filesystem::current_path(err_code).string();
+    message_header hdr = {message_kind::RUN, static_cast<std::uint32_t>(argc), 0, 0};
+    int std_fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    char ctrl[CMSG_SPACE(sizeof(std_fds))] = {};
+    iovec iov = {&hdr, sizeof(hdr)};
+    msghdr msg = {};
+    cmsghdr* cmsg;
+    pid_t pid;
+    struct sigaction sig_actn = {};
+    struct sigaction prev_actns[3];
+    const int sigs[3] = {SIGINT, SIGTERM, SIGHUP};
+    int fd;
+    bool sent;
+    bool replied = false;
+    
+    if (payld.empty())
+    {
+        return false;
+    }
+    
+    fd = connect_to(sock_path);
+    if (fd < 0)
+    {
+        return false;
+    }
+    
+    payld += '\0';
+    
+    for (int i = 0; i < argc; i++)
+    {
+        payld += argv[i];
+        payld += '\0';
+    }
+    
+    for (char** env = environ; *env != nullptr; env++)
+    {
+        payld += *env;
+        payld += '\0';
+    }
+    
+    hdr.sze = payld.size();
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(std_fds));
+    std::memcpy(CMSG_DATA(cmsg), std_fds, sizeof(std_fds));
+    
+    std::cout.flush();
+    std::cerr.flush();
+    
+    wrkr_pid = 0;
+    fwd_sig = 0;
+    sig_actn.sa_handler = forward_signal;
+    ::sigemptyset(&sig_actn.sa_mask);
+    
+    for (int i = 0; i < 3; i++)
+    {
+        ::sigaction(sigs[i], nullptr, &prev_actns[i]);
+        
+        if (prev_actns[i].sa_handler != SIG_IGN)
+        {
+            ::sigaction(sigs[i], &sig_actn, nullptr);
+        }
+    }
+    
+    sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(hdr) &&
+           write_all(fd, payld.data(), payld.size());
+    
+    if (sent && read_all(fd, &pid, sizeof(pid)))
+    {
+        wrkr_pid = pid;
+        
+        if (fwd_sig != 0)
+        {
+            ::kill(-pid, fwd_sig);
+        }
+        
+        replied = read_all(fd, res, sizeof(*res));
+    }
+    
+    for (int i = 0; i < 3; i++)
+    {
+        ::sigaction(sigs[i], &prev_actns[i], nullptr);
+    }
+    
+    wrkr_pid = 0;
+    ::close(fd);
+    
+    if (!replied && fwd_sig != 0)
+    {
+        std::raise(fwd_sig);
+    }
+    
+    if (!sent)
+    {
+        return false;
+    }
+    
+    if (!replied)
+    {
+        std::cerr << "runsource: the daemon stopped before completing the request"
+                  << spd::ios::newl;
+        *res = -1;
+    }
+    
+    return true;
+}
+
+
+int serve_requests(
+        const std::filesystem::path& sock_path,
+        const std::function<int(int, char*[])>& handlr
+)
+{
+    sockaddr_un addr;
+    mode_t prev_umask;
+    int fd;
+    int clnt_fd;
+    int std_fds[3];
+    message_header hdr;
+    timeval tmeout = {1, 0};
+    warm_cache wrm_cache(warm_cache_sze);
+    bool recvd;
+    pid_t pid;
+    int err = 0;
+    std::error_code err_code;
+    
+    fd = connect_to(sock_path);
+    if (fd >= 0)
+    {
+        ::close(fd);
+        std::cerr << "runsource: a daemon is already listening on " << sock_path.string()
+                  << spd::ios::newl;
+        return -1;
+    }
+    
+    if (!get_socket_address(sock_path, &addr))
+    {
+        std::cerr << "runsource: socket path too long: " << sock_path.string() << spd::ios::newl;
+        return -1;
+    }
+    
+    std::filesystem::create_directories(sock_path.parent_path(), err_code);
+    std::filesystem::remove(sock_path, err_code);
+    
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    prev_umask = ::umask(077);
+    
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd, 16) != 0)
+    {
+        err = errno;
+    }
+    
+    ::umask(prev_umask);
+    
+    if (err != 0)
+    {
+        std::cerr << "runsource: cannot listen on " << sock_path.string() << ": "
+                  << std::strerror(err) << spd::ios::newl;
+        return -1;
+    }
+    
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGCHLD, SIG_IGN);
+    
+    while (true)
+    {
+        clnt_fd = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        
+        if (clnt_fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            
+            break;
+        }
+        
+        std::fill(std::begin(std_fds), std::end(std_fds), -1);
+        ::setsockopt(clnt_fd, SOL_SOCKET, SO_RCVTIMEO, &tmeout, sizeof(tmeout));
+        
+        recvd = receive_header(clnt_fd, &hdr, std_fds);
+        
+        if (recvd && hdr.kind != message_kind::RUN)
+        {
+            wrm_cache.serve(clnt_fd, hdr);
+        }
+        else if (recvd)
+        {
+            std::cout.flush();
+            std::cerr.flush();
+            
+            pid = ::fork();
+            
+            if (pid == 0)
+            {
+                ::close(fd);
+                ::setsid();
+                
+                for (int x : {SIGINT, SIGTERM, SIGHUP, SIGQUIT, SIGPIPE, SIGCHLD})
+                {
+                    std::signal(x, SIG_DFL);
+                }
+                
+                set_warm_cache_path(sock_path);
+                handle_request(clnt_fd, hdr, std_fds, handlr);
+                ::_exit(0);
+            }
+            
+            if (pid < 0)
+            {
+                std::cerr << "runsource: cannot fork a worker: " << std::strerror(errno)
+                          << spd::ios::newl;
+            }
+        }
+        
+        for (auto& x : std_fds)
+        {
+            if (x >= 0)
+            {
+                ::close(x);
+            }
+        }
+        
+        ::close(clnt_fd);
+    }
+    
+    ::close(fd);
+    std::filesystem::remove(sock_path, err_code);
+    
+    return -1;
+}
+
+
+}
@@ -0,0 +1,42 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_DAEMON_HPP
+#define RUNSOURCE_DAEMON_HPP
+
+#include <filesystem>
+#include <functional>
+
+
+namespace runsource {
+
+
+bool forward_request(const std::filesystem::path& sock_path, int argc, char* argv[], int* res);
+
+
+int serve_requests(
+        const std::filesystem::path& sock_path,
+        const std::function<int(int, char*[])>& handlr
+);
+
+
+}
+
+
+#endif
@@ -0,0 +1,94 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "depfile.hpp"
+
+
+namespace runsource {
+
+
+std::vector<std::filesystem::path> parse_depfile(const std::filesystem::path& fle_path)
+{
+    std::vector<std::filesystem::path> deps;
+    std::ifstream ifs(fle_path);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::string dep;
+    std::size_t i = content.find(": ");
+    
+    if (i == std::string::npos)
+    {
+        return deps;
+    }
+    
+    for (i += 2; i < content.size(); i++)
+    {
+        if (content[i] == '\\' && i + 1 < content.size())
+        {
+            if (content[i + 1] == '\n')
+            {
+                i++;
+                continue;
+            }
+            
+            if (content[i + 1] == ' ' || content[i + 1] == '#')
+            {
+                dep += content[++i];
+                continue;
+            }
+        }
+        
+        if (content[i] == '$' && i + 1 < content.size() && content[i + 1] == '$')
+        {
+            dep += content[++i];
+            continue;
+        }
+        
+        if (content[i] == ' ' || content[i] == '\t' || content[i] == '\n')
+        {
+            if (!dep.empty())
+            {
+                deps.emplace_back(std::move(dep));
+                dep.clear();
+            }
+            
+            if (content[i] == '\n' && i + 1 < content.size() && content[i + 1] != ' ')
+            {
+                break;
+            }
+            
+            continue;
+        }
+        
+        dep += content[i];
+    }
+    
+    if (!dep.empty())
+    {
+        deps.emplace_back(std::move(dep));
+    }
+    
+    return deps;
+}
+
+
+}
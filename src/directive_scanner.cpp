@@ -0,0 +1,401 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "directive_scanner.hpp"
+#include "job_pool.hpp"
+#include "warm_cache.hpp"
+
+
+namespace runsource {
+
+
+struct scanned_file
+{
+    std::uintmax_t sze;
+    
+    std::filesystem::file_time_type mtime;
+    
+    std::vector<directive> dirs;
+};
+
+
+static const char* skip_blanks(const char* cur, const char* end)
+{
+    while (cur < end && (*cur == ' ' || *cur == '\t'))
+    {
+        cur++;
+    }
+    
+    return cur;
+}
+
+
+static bool skip_word(const char** cur, const char* end, const char* wrd)
+{
+    std::size_t len = std::strlen(wrd);
+    
+    if (static_cast<std::size_t>(end - *cur) < len || std::memcmp(*cur, wrd, len) != 0)
+    {
+        return false;
+    }
+    
+    *cur += len;
+    
+    return true;
+}
+
+
+static bool parse_include(const char* cur, const char* end, directive* dir)
+{
+    const char* close;
+    
+    if (cur == end || (*cur != '"' && *cur != '<'))
+    {
+        return false;
+    }
+    
+    close = static_cast<const char*>(std::memchr(cur + 1, *cur == '"' ? '"' : '>', end - cur - 1));
+    if (close == nullptr)
+    {
+        return false;
+    }
+    
+    dir->typ = directive_type::INCLUDE;
+    dir->val.assign(cur, close + 1);
+    
+    return true;
+}
+
+
+static bool parse_pragma(const char* cur, const char* end, directive* dir)
+{
+    const char* open;
+    const char* close;
+    
+    if (!skip_word(&cur, end, "comment"))
+    {
+        return false;
+    }
+    
+    cur = skip_blanks(cur, end);
+    if (!skip_word(&cur, end, "("))
+    {
+        return false;
+    }
+    
+    cur = skip_blanks(cur, end);
+    if (!skip_word(&cur, end, "lib"))
+    {
+        return false;
+    }
+    
+    cur = skip_blanks(cur, end);
+    if (!skip_word(&cur, end, ","))
+    {
+        return false;
+    }
+    
+    while (end > cur && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+    {
+        end--;
+    }
+    
+    if (end == cur || end[-1] != ')')
+    {
+        return false;
+    }
+    
+    open = static_cast<const char*>(std::memchr(cur, '"', end - cur));
+    close = static_cast<const char*>(::memrchr(cur, '"', end - cur));
+    if (open == nullptr || close - open < 2)
+    {
+        return false;
+    }
+    
+    dir->typ = directive_type::LINK_LIB;
+    dir->val.assign(open + 1, close);
+    
+    return true;
+}
+
+
+static bool parse_directive(const char* cur, const char* end, directive* dir)
+{
+    static const std::pair<const char*, bool (*)(const char*, const char*, directive*)> parsrs[] = {
+            {"include", parse_include},
+            {"pragma", parse_pragma},
+    };
+    
+    cur = skip_blanks(cur, end);
+    
+    for (auto& x : parsrs)
+    {
+        if (skip_word(&cur, end, x.first))
+        {
+            return x.second(skip_blanks(cur, end), end, dir);
+        }
+    }
+    
+    return false;
+}
+
+
+static bool is_continued(const char* beg, const char* line_end)
+{
+    if (line_end > beg && line_end[-1] == '\r')
+    {
+        line_end--;
+    }
+    
+    return line_end > beg && line_end[-1] == '\\';
+}
+
+
+static const char* find_line_end(const char* cur, const char* end)
+{
+    const char* line_end;
+    
+    while ((line_end = static_cast<const char*>(std::memchr(cur, '\n', end - cur))) != nullptr &&
+           is_continued(cur, line_end))
+    {
+        cur = line_end + 1;
+    }
+    
+    return line_end == nullptr ? end : line_end;
+}
+
+
+static std::string join_continued_lines(const char* cur, const char* end)
+{
+    std::string line;
+    const char* nl;
+    
+    while ((nl = static_cast<const char*>(std::memchr(cur, '\n', end - cur))) != nullptr)
+    {
+        line.append(cur, nl - (nl[-1] == '\r' ? 2 : 1));
+        cur = nl + 1;
+    }
+    
+    line.append(cur, end);
+    
+    return line;
+}
+
+
+static bool parse_directive_lines(const char* cur, const char* end, directive* dir)
+{
+    std::string line;
+    
+    if (std::memchr(cur, '\n', end - cur) == nullptr)
+    {
+        return parse_directive(cur, end, dir);
+    }
+    
+    line = join_continued_lines(cur, end);
+    
+    return parse_directive(line.data(), line.data() + line.size(), dir);
+}
+
+
+static std::string encode_directives(const std::vector<directive>& dirs)
+{
+    std::string str;
+    
+    for (auto& x : dirs)
+    {
+        str += static_cast<char>(x.typ);
+        str += x.val;
+        str += '\0';
+    }
+    
+    return str;
+}
+
+
+static std::vector<directive> decode_directives(const std::string& str)
+{
+    std::vector<directive> dirs;
+    std::size_t pos;
+    std::size_t end_pos;
+    
+    for (pos = 0; pos < str.size(); pos = end_pos + 1)
+    {
+        end_pos = str.find('\0', pos);
+        if (end_pos == std::string::npos)
+        {
+            break;
+        }
+        
+        dirs.push_back({static_cast<directive_type>(str[pos]),
+                        str.substr(pos + 1, end_pos - pos - 1)});
+    }
+    
+    return dirs;
+}
+
+
+static std::vector<directive> scan_directives(const char* beg, const char* end)
+{
+    std::vector<directive> dirs;
+    directive dir;
+    const char* cur = beg;
+    const char* line_beg;
+    const char* line_end;
+    
+    while (cur < end)
+    {
+        cur = static_cast<const char*>(std::memchr(cur, '#', end - cur));
+        if (cur == nullptr)
+        {
+            break;
+        }
+        
+        line_beg = cur;
+        while (line_beg > beg && (line_beg[-1] == ' ' || line_beg[-1] == '\t'))
+        {
+            line_beg--;
+        }
+        
+        line_end = find_line_end(cur, end);
+        
+        if ((line_beg == beg || (line_beg[-1] == '\n' && !is_continued(beg, line_beg - 1))) &&
+            parse_directive_lines(cur + 1, line_end, &dir))
+        {
+            dirs.push_back(std::move(dir));
+        }
+        
+        cur = line_end;
+    }
+    
+    return dirs;
+}
+
+
+std::vector<directive> scan_directives(const std::filesystem::path& fle_path)
+{
+    static std::map<std::filesystem::path, scanned_file> scanned_fles;
+    static std::mutex mtx;
+    std::vector<directive> dirs;
+    std::error_code err_code;
+    std::uintmax_t sze = std::filesystem::file_size(fle_path, err_code);
+    std::filesystem::file_time_type mtime = std::filesystem::last_write_time(fle_path, err_code);
+    std::string ky;
+    std::string val;
+    
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = scanned_fles.find(fle_path);
+        
+        if (it != scanned_fles.end() && it->second.sze == sze && it->second.mtime == mtime)
+        {
+            return it->second.dirs;
+        }
+    }
+    
+    ky = "scan:" + std::filesystem::absolute(fle_path, err_code).string() + ':' +
+         std::to_string(sze) + ':' + std::to_string(mtime.time_since_epoch().count());
+    
+    if (lookup_warm_value(ky, &val))
+    {
+        dirs = decode_directives(val);
+    }
+    else
+    {
+        dirs = read_directives(fle_path);
+        store_warm_value(ky, encode_directives(dirs));
+    }
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    scanned_fles[fle_path] = {sze, mtime, dirs};
+    
+    return dirs;
+}
+
+
+std::vector<std::vector<directive>> scan_directives(
+        const std::vector<std::filesystem::path>& fles,
+        std::size_t jobs
+)
+{
+    std::vector<std::vector<directive>> dirs(fles.size());
+    job_pool pool(jobs);
+    
+    if (fles.size() == 1)
+    {
+        dirs.front() = scan_directives(fles.front());
+        return dirs;
+    }
+    
+    for (std::size_t i = 0; i < fles.size(); i++)
+    {
+        pool.push([&, i]() {
+            dirs[i] = scan_directives(fles[i]);
+            return 0;
+        });
+    }
+    
+    pool.run();
+    
+    return dirs;
+}
+
+
+std::vector<directive> read_directives(const std::filesystem::path& fle_path)
+{
+    std::vector<directive> dirs;
+    struct stat st;
+    void* addr;
+    int fd;
+    
+    fd = ::open(fle_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return dirs;
+    }
+    
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        
+        if (addr != MAP_FAILED)
+        {
+            ::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            dirs = scan_directives(static_cast<const char*>(addr),
+                                   static_cast<const char*>(addr) + st.st_size);
+            ::munmap(addr, st.st_size);
+        }
+    }
+    
+    ::close(fd);
+    
+    return dirs;
+}
+
+
+}
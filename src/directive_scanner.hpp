@@ -0,0 +1,63 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_DIRECTIVE_SCANNER_HPP
+#define RUNSOURCE_DIRECTIVE_SCANNER_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace runsource {
+
+
+enum class directive_type
+{
+    NIL,
+    INCLUDE,
+    LINK_LIB,
+};
+
+
+struct directive
+{
+    directive_type typ;
+    
+    std::string val;
+};
+
+
+std::vector<directive> scan_directives(const std::filesystem::path& fle_path);
+
+
+std::vector<std::vector<directive>> scan_directives(
+        const std::vector<std::filesystem::path>& fles,
+        std::size_t jobs
+);
+
+
+std::vector<directive> read_directives(const std::filesystem::path& fle_path);
+
+
+}
+
+
+#endif
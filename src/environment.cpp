@@ -0,0 +1,183 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "environment.hpp"
+
+
+namespace runsource {
+
+
+std::filesystem::path find_executable(const std::string& exe_nme)
+{
+    static std::map<std::string, std::filesystem::path> found_exes;
+    static std::mutex mtx;
+    const char* path_env = std::getenv("PATH");
+    std::stringstream strstream(path_env != nullptr ? path_env : "/usr/local/bin:/usr/bin:/bin");
+    std::string ky = strstream.str() + '\0' + exe_nme;
+    std::string dir;
+    std::filesystem::path exe_path;
+    
+    if (exe_nme.find('/') != std::string::npos)
+    {
+        return ::access(exe_nme.c_str(), X_OK) == 0 ? std::filesystem::path(exe_nme) :
+                                                      std::filesystem::path();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = found_exes.find(ky);
+        
+        if (it != found_exes.end() && ::access(it->second.c_str(), X_OK) == 0)
+        {
+            return it->second;
+        }
+    }
+    
+    while (std::getline(strstream, dir, ':'))
+    {
+        exe_path = dir.empty() ? "." : dir;
+        exe_path /= exe_nme;
+        
+        if (::access(exe_path.c_str(), X_OK) == 0)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            found_exes[ky] = exe_path;
+            
+            return exe_path;
+        }
+    }
+    
+    return std::filesystem::path();
+}
+
+
+std::string get_executable_id(const std::string& exe_nme)
+{
+    std::filesystem::path exe_path = find_executable(exe_nme);
+    std::error_code err_code;
+    std::string id;
+    
+    if (exe_path.empty())
+    {
+        return exe_nme;
+    }
+    
+    exe_path = std::filesystem::canonical(exe_path, err_code);
+    id = exe_path.string();
+    id += ':';
+    id += std::to_string(std::filesystem::file_size(exe_path, err_code));
+    id += ':';
+    id += std::to_string(std::filesystem::last_write_time(exe_path, err_code)
+                                 .time_since_epoch().count());
+    
+    return id;
+}
+
+
+std::filesystem::path get_cache_path()
+{
+    const char* xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    std::filesystem::path cache_path;
+    
+    if (xdg_cache_home != nullptr && *xdg_cache_home != '\0')
+    {
+        cache_path = xdg_cache_home;
+    }
+    else if (home != nullptr && *home != '\0')
+    {
+        cache_path = home;
+        cache_path /= ".cache";
+    }
+    else
+    {
+        cache_path = "/tmp";
+    }
+    
+    cache_path /= "runsource";
+    
+    return cache_path;
+}
+
+
+std::filesystem::path get_socket_path()
+{
+    const char* xdg_runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    
+    if (xdg_runtime_dir != nullptr && *xdg_runtime_dir != '\0')
+    {
+        return std::filesystem::path(xdg_runtime_dir) / "runsource.sock";
+    }
+    
+    return get_cache_path() / "daemon.sock";
+}
+
+
+std::filesystem::path get_tmpfs_path()
+{
+    std::error_code err_code;
+    
+    if (std::filesystem::is_directory("/dev/shm", err_code) && ::access("/dev/shm", W_OK) == 0)
+    {
+        return "/dev/shm";
+    }
+    
+    return spd::sys::fsys::get_tmp_path();
+}
+
+
+std::filesystem::path get_include_path()
+{
+    static const std::filesystem::path inc_path = []() {
+        std::error_code err_code;
+        std::filesystem::path exe_path = std::filesystem::read_symlink("/proc/self/exe", err_code);
+        
+        if (err_code)
+        {
+            return std::filesystem::path();
+        }
+        
+        std::filesystem::path prefx_path = exe_path.parent_path().parent_path();
+        
+        for (auto& x : {prefx_path / "share" / "runsource" / "include", prefx_path / "include"})
+        {
+            if (std::filesystem::exists(x / "runsource" / "bench.hpp", err_code))
+            {
+                return x;
+            }
+        }
+        
+        return std::filesystem::path();
+    }();
+    
+    return inc_path;
+}
+
+
+}
@@ -0,0 +1,51 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_ENVIRONMENT_HPP
+#define RUNSOURCE_ENVIRONMENT_HPP
+
+#include <filesystem>
+#include <string>
+
+
+namespace runsource {
+
+
+std::filesystem::path find_executable(const std::string& exe_nme);
+
+
+std::string get_executable_id(const std::string& exe_nme);
+
+
+std::filesystem::path get_cache_path();
+
+
+std::filesystem::path get_socket_path();
+
+
+std::filesystem::path get_tmpfs_path();
+
+
+std::filesystem::path get_include_path();
+
+
+}
+
+
+#endif
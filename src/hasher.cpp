@@ -0,0 +1,96 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "hasher.hpp"
+
+
+namespace runsource {
+
+
+hasher::hasher() noexcept
+        : digest_(14695981039346656037ull)
+{
+}
+
+
+void hasher::update(const void* dat, std::size_t sze) noexcept
+{
+    auto* byts = static_cast<const unsigned char*>(dat);
+    
+    for (std::size_t i = 0; i < sze; i++)
+    {
+        digest_ ^= byts[i];
+        digest_ *= 1099511628211ull;
+    }
+}
+
+
+void hasher::update(const std::string& str) noexcept
+{
+    update(static_cast<std::uint64_t>(str.size()));
+    update(str.data(), str.size());
+}
+
+
+void hasher::update(std::uint64_t val) noexcept
+{
+    update(&val, sizeof(val));
+}
+
+
+bool hasher::update_from_file(const std::filesystem::path& fle_path)
+{
+    char buf[65536];
+    std::ifstream ifs(fle_path, std::ios::binary);
+    
+    if (!ifs)
+    {
+        return false;
+    }
+    
+    while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0)
+    {
+        update(buf, static_cast<std::size_t>(ifs.gcount()));
+    }
+    
+    return true;
+}
+
+
+std::uint64_t hasher::get_digest() const noexcept
+{
+    return digest_;
+}
+
+
+std::string hasher::get_hex_digest() const
+{
+    std::stringstream strstream;
+    
+    strstream << std::hex << std::setw(16) << std::setfill('0') << digest_;
+    
+    return strstream.str();
+}
+
+
+}
@@ -0,0 +1,56 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_HASHER_HPP
+#define RUNSOURCE_HASHER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+
+namespace runsource {
+
+
+class hasher
+{
+public:
+    hasher() noexcept;
+    
+    void update(const void* dat, std::size_t sze) noexcept;
+    
+    void update(const std::string& str) noexcept;
+    
+    void update(std::uint64_t val) noexcept;
+    
+    bool update_from_file(const std::filesystem::path& fle_path);
+    
+    std::uint64_t get_digest() const noexcept;
+    
+    std::string get_hex_digest() const;
+
+private:
+    std::uint64_t digest_;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,344 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "hasher.hpp"
+#include "history.hpp"
+#include "launcher.hpp"
+#include "statistics.hpp"
+
+
+namespace runsource {
+
+
+static const double significance_lvl = 0.05;
+
+
+static const std::uintmax_t max_log_sze = 4 * 1024 * 1024;
+
+
+static const std::size_t min_samples = 5;
+
+
+static std::string get_change(const history_entry& prev, const history_entry& cur, bool* signif)
+{
+    std::ostringstream oss;
+    rank_test_result res = mann_whitney_u_test(cur.tmes, prev.tmes);
+    double prev_med = summarize(prev.tmes).median;
+    double cur_med = summarize(cur.tmes).median;
+    
+    *signif = res.p_value < significance_lvl;
+    
+    oss << std::showpos << std::fixed << std::setprecision(1)
+        << (prev_med > 0 ? (cur_med / prev_med - 1) * 100 : 0) << "%" << std::noshowpos
+        << " (p = " << std::setprecision(3) << res.p_value
+        << ", r = " << std::setprecision(2) << res.effect_sze << ")";
+    
+    return oss.str();
+}
+
+
+static void trim_history(const std::filesystem::path& log_path)
+{
+    std::ifstream ifs(log_path);
+    std::ofstream ofs;
+    std::ostringstream oss;
+    std::string conts;
+    std::filesystem::path tmp_path = log_path;
+    std::error_code err_code;
+    std::size_t pos;
+    
+    oss << ifs.rdbuf();
+    conts = oss.str();
+    
+    if (conts.size() <= max_log_sze ||
+        (pos = conts.find('\n', conts.size() - max_log_sze / 2)) == std::string::npos)
+    {
+        return;
+    }
+    
+    tmp_path += "." + std::to_string(spd::sys::proc::get_pid());
+    
+    ofs.open(tmp_path, std::ios::trunc);
+    ofs.write(conts.data() + pos + 1, conts.size() - pos - 1);
+    ofs.close();
+    
+    if (!ofs)
+    {
+        std::filesystem::remove(tmp_path, err_code);
+        return;
+    }
+    
+    std::filesystem::rename(tmp_path, log_path, err_code);
+}
+
+
+history_entry make_history_entry(
+        const run_record& rec,
+        bool monotonic_chrn,
+        const std::vector<std::string>& meas_config
+)
+{
+    history_entry entry;
+    hasher config_hshr;
+    hasher content_hshr;
+    
+    entry.timestamp = rec.timestamp;
+    entry.config = {rec.lang};
+    
+    for (auto& x : {rec.tool_chn, rec.standard, std::string(rec.optmz ? "-O3" : "")})
+    {
+        if (!x.empty())
+        {
+            entry.config.push_back(x);
+        }
+    }
+    
+    entry.config.insert(entry.config.end(), rec.flgs.begin(), rec.flgs.end());
+    entry.config.emplace_back(monotonic_chrn ? "wall" : "cpu");
+    entry.config.insert(entry.config.end(), meas_config.begin(), meas_config.end());
+    
+    config_hshr.update(rec.hostname);
+    
+    for (auto& x : entry.config)
+    {
+        config_hshr.update(x);
+    }
+    
+    for (auto& x : rec.fle_hashes)
+    {
+        entry.fles.push_back(x.first);
+        config_hshr.update(x.first);
+        content_hshr.update(x.second);
+    }
+    
+    for (auto& x : rec.samples)
+    {
+        entry.tmes.push_back(monotonic_chrn ? x.wall_tme : x.cpu_tme);
+    }
+    
+    entry.config_ky = config_hshr.get_hex_digest();
+    entry.content_ky = content_hshr.get_hex_digest();
+    
+    return entry;
+}
+
+
+bool is_comparable(const history_entry& entry) noexcept
+{
+    return entry.tmes.size() >= min_samples;
+}
+
+
+bool append_history(const std::filesystem::path& log_path, const history_entry& entry)
+{
+    std::ostringstream oss;
+    std::string line;
+    std::error_code err_code;
+    int fd;
+    bool written;
+    
+    oss << entry.timestamp << '\t' << entry.config_ky << '\t' << entry.content_ky << '\t'
+        << join_arguments(entry.fles) << '\t' << join_arguments(entry.config) << '\t'
+        << std::setprecision(9);
+    
+    for (std::size_t i = 0; i < entry.tmes.size(); i++)
+    {
+        oss << (i == 0 ? "" : ",") << entry.tmes[i];
+    }
+    
+    oss << '\n';
+    line = oss.str();
+    
+    std::filesystem::create_directories(log_path.parent_path(), err_code);
+    
+    fd = ::open(log_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    
+    written = ::write(fd, line.data(), line.size()) == static_cast<ssize_t>(line.size());
+    ::close(fd);
+    
+    if (written && std::filesystem::file_size(log_path, err_code) > max_log_sze)
+    {
+        trim_history(log_path);
+    }
+    
+    return written;
+}
+
+
+std::vector<history_entry> read_history(const std::filesystem::path& log_path)
+{
+    std::vector<history_entry> entries;
+    std::ifstream ifs(log_path);
+    std::string line;
+    std::string fles;
+    std::string config;
+    std::string tmes;
+    std::string tme;
+    
+    while (std::getline(ifs, line))
+    {
+        std::istringstream iss(line);
+        history_entry entry;
+        
+        if (!std::getline(iss, entry.timestamp, '\t') ||
+            !std::getline(iss, entry.config_ky, '\t') ||
+            !std::getline(iss, entry.content_ky, '\t') ||
+            !std::getline(iss, fles, '\t') ||
+            !std::getline(iss, config, '\t') ||
+            !std::getline(iss, tmes))
+        {
+            continue;
+        }
+        
+        entry.fles = split_arguments(fles);
+        entry.config = split_arguments(config);
+        
+        std::istringstream tmes_iss(tmes);
+        
+        while (std::getline(tmes_iss, tme, ','))
+        {
+            entry.tmes.push_back(std::strtod(tme.c_str(), nullptr));
+        }
+        
+        if (!entry.tmes.empty())
+        {
+            entries.push_back(std::move(entry));
+        }
+    }
+    
+    return entries;
+}
+
+
+void compare_with_history(
+        std::ostream& os,
+        const std::vector<history_entry>& entries,
+        const history_entry& entry
+)
+{
+    std::string change;
+    bool signif;
+    
+    if (!is_comparable(entry))
+    {
+        return;
+    }
+    
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+    {
+        if (it->config_ky != entry.config_ky || !is_comparable(*it))
+        {
+            continue;
+        }
+        
+        change = get_change(*it, entry, &signif);
+        
+        os << "Compared with the run of " << it->timestamp
+           << (it->content_ky == entry.content_ky ? " (same sources): " : " (other sources): ");
+        
+        if (!signif)
+        {
+            os << "no significant change, " << change << spd::ios::newl;
+        }
+        else
+        {
+            os << (change.front() == '+' ? "SLOWDOWN " : "SPEEDUP ") << change << spd::ios::newl;
+        }
+        
+        return;
+    }
+}
+
+
+void print_history(
+        std::ostream& os,
+        const std::vector<history_entry>& entries,
+        const std::filesystem::path& fle_path
+)
+{
+    std::map<std::string, const history_entry*> lsts;
+    std::string change;
+    bool signif;
+    std::size_t n_entries = 0;
+    
+    os << std::left << std::setw(22) << "Date"
+       << std::setw(10) << "Sources"
+       << std::setw(32) << "Configuration" << std::right
+       << std::setw(6) << "Runs"
+       << std::setw(14) << "median (s)"
+       << "  Change" << spd::ios::newl;
+    
+    for (auto& x : entries)
+    {
+        if (std::find(x.fles.begin(), x.fles.end(), fle_path.string()) == x.fles.end())
+        {
+            continue;
+        }
+        
+        change = "-";
+        signif = false;
+        
+        if (lsts.count(x.config_ky) != 0 && is_comparable(x) && is_comparable(*lsts[x.config_ky]))
+        {
+            change = get_change(*lsts[x.config_ky], x, &signif);
+        }
+        
+        os << std::left << std::setw(22) << x.timestamp
+           << std::setw(10) << x.content_ky.substr(0, 8)
+           << std::setw(32) << join_arguments(x.config) << std::right
+           << std::setw(6) << x.tmes.size()
+           << std::setw(14) << std::fixed << std::setprecision(6) << summarize(x.tmes).median
+           << "  " << change << (signif ? " *" : "") << spd::ios::newl;
+        
+        lsts[x.config_ky] = &x;
+        n_entries++;
+    }
+    
+    if (n_entries == 0)
+    {
+        os << "No run of " << fle_path.string() << " recorded." << spd::ios::newl;
+    }
+    else
+    {
+        os << "Changes are against the previous run of the same configuration, * marks a "
+              "significant one (Mann-Whitney U, p < " << std::setprecision(2)
+           << significance_lvl << ")." << spd::ios::newl;
+    }
+}
+
+
+}
@@ -0,0 +1,83 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_HISTORY_HPP
+#define RUNSOURCE_HISTORY_HPP
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "run_record.hpp"
+
+
+namespace runsource {
+
+
+struct history_entry
+{
+    std::string timestamp;
+    
+    std::string config_ky;
+    
+    std::string content_ky;
+    
+    std::vector<std::string> fles;
+    
+    std::vector<std::string> config;
+    
+    std::vector<double> tmes;
+};
+
+
+history_entry make_history_entry(
+        const run_record& rec,
+        bool monotonic_chrn,
+        const std::vector<std::string>& meas_config
+);
+
+
+bool is_comparable(const history_entry& entry) noexcept;
+
+
+bool append_history(const std::filesystem::path& log_path, const history_entry& entry);
+
+
+std::vector<history_entry> read_history(const std::filesystem::path& log_path);
+
+
+void compare_with_history(
+        std::ostream& os,
+        const std::vector<history_entry>& entries,
+        const history_entry& entry
+);
+
+
+void print_history(
+        std::ostream& os,
+        const std::vector<history_entry>& entries,
+        const std::filesystem::path& fle_path
+);
+
+
+}
+
+
+#endif
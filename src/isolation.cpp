@@ -0,0 +1,363 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/personality.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "isolation.hpp"
+
+
+namespace runsource {
+
+
+isolation::isolation()
+        : isolation(false, {}, false, false)
+{
+}
+
+
+isolation::isolation(bool pin, std::vector<int> cpus, bool no_aslr, bool strict)
+        : pin_(pin || !cpus.empty())
+        , cpus_(std::move(cpus))
+        , no_aslr_(no_aslr)
+        , strict_(strict)
+        , entered_(false)
+        , cpu_set_()
+        , prev_cpu_set_()
+        , prev_cpu_set_vld_(false)
+        , throttle_cnt_(0)
+{
+}
+
+
+bool isolation::is_enabled() const noexcept
+{
+    return pin_ || no_aslr_;
+}
+
+
+bool isolation::enter()
+{
+    std::vector<std::string> warns;
+    cpu_set_t helpr_cpu_set;
+    
+    if (!is_enabled() || entered_)
+    {
+        return true;
+    }
+    
+    if (pin_)
+    {
+        if (::sched_getaffinity(0, sizeof(prev_cpu_set_), &prev_cpu_set_) != 0)
+        {
+            std::cerr << "runsource: cannot read the allowed cores" << spd::ios::newl;
+            return false;
+        }
+        
+        if (cpus_.empty())
+        {
+            for (int i = CPU_SETSIZE - 1; i >= 0; i--)
+            {
+                if (CPU_ISSET(i, &prev_cpu_set_))
+                {
+                    cpus_.push_back(i);
+                    break;
+                }
+            }
+        }
+        
+        CPU_ZERO(&cpu_set_);
+        helpr_cpu_set = prev_cpu_set_;
+        
+        for (auto& x : cpus_)
+        {
+            if (!CPU_ISSET(x, &prev_cpu_set_))
+            {
+                std::cerr << "runsource: cannot pin to core " << x << spd::ios::newl;
+                return false;
+            }
+            
+            CPU_SET(x, &cpu_set_);
+            CPU_CLR(x, &helpr_cpu_set);
+        }
+        
+        for (auto& x : get_noise_notes())
+        {
+            std::cerr << "runsource: note: " << x << spd::ios::newl;
+        }
+        
+        warns = get_noise_warnings();
+        
+        for (auto& x : warns)
+        {
+            std::cerr << "runsource: warning: " << x << spd::ios::newl;
+        }
+        
+        if (strict_ && !warns.empty())
+        {
+            std::cerr << "runsource: the environment is too noisy to measure" << spd::ios::newl;
+            return false;
+        }
+        
+        if (CPU_COUNT(&helpr_cpu_set) > 0)
+        {
+            prev_cpu_set_vld_ = ::sched_setaffinity(0, sizeof(helpr_cpu_set), &helpr_cpu_set) == 0;
+        }
+        
+        throttle_cnt_ = get_throttle_count();
+    }
+    
+    if (no_aslr_ && ::personality(0xffffffff) < 0)
+    {
+        std::cerr << "runsource: warning: cannot disable address space layout randomization"
+                  << spd::ios::newl;
+        no_aslr_ = false;
+    }
+    
+    entered_ = true;
+    
+    return true;
+}
+
+
+void isolation::apply() const
+{
+    int persona;
+    int nice;
+    
+    if (!entered_)
+    {
+        return;
+    }
+    
+    if (pin_)
+    {
+        ::sched_setaffinity(0, sizeof(cpu_set_), &cpu_set_);
+        
+        errno = 0;
+        nice = ::getpriority(PRIO_PROCESS, 0);
+        
+        if (errno == 0)
+        {
+            for (auto x : {-20, -10, -5})
+            {
+                if (x < nice && ::setpriority(PRIO_PROCESS, 0, x) == 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    
+    if (no_aslr_)
+    {
+        persona = ::personality(0xffffffff);
+        
+        if (persona >= 0)
+        {
+            ::personality(persona | ADDR_NO_RANDOMIZE);
+        }
+    }
+}
+
+
+void isolation::leave()
+{
+    if (!entered_)
+    {
+        return;
+    }
+    
+    if (pin_)
+    {
+        if (get_throttle_count() != throttle_cnt_)
+        {
+            std::cerr << "runsource: warning: the CPU was thermally throttled during the runs"
+                      << spd::ios::newl;
+        }
+        
+        if (prev_cpu_set_vld_)
+        {
+            ::sched_setaffinity(0, sizeof(prev_cpu_set_), &prev_cpu_set_);
+            prev_cpu_set_vld_ = false;
+        }
+    }
+    
+    entered_ = false;
+}
+
+
+std::vector<std::string> isolation::get_settings() const
+{
+    std::vector<std::string> setngs;
+    std::string cpus;
+    
+    for (auto& x : cpus_)
+    {
+        cpus += (cpus.empty() ? "" : ",") + std::to_string(x);
+    }
+    
+    if (pin_)
+    {
+        setngs.push_back(cpus.empty() ? "isolate" : "cpus=" + cpus);
+    }
+    
+    if (no_aslr_)
+    {
+        setngs.emplace_back("no-aslr");
+    }
+    
+    return setngs;
+}
+
+
+bool isolation::parse_cpu_list(const std::string& str, std::vector<int>* cpus)
+{
+    std::stringstream strstream(str);
+    std::string rng;
+    std::size_t pos;
+    char* end;
+    long frst;
+    long lst;
+    
+    while (std::getline(strstream, rng, ','))
+    {
+        frst = std::strtol(rng.c_str(), &end, 10);
+        pos = end - rng.c_str();
+        lst = frst;
+        
+        if (pos < rng.size() && rng[pos] == '-')
+        {
+            lst = std::strtol(rng.c_str() + pos + 1, &end, 10);
+        }
+        
+        if (rng.empty() || *end != '\0' || frst < 0 || lst < frst || lst >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        
+        for (long i = frst; i <= lst; i++)
+        {
+            cpus->push_back(static_cast<int>(i));
+        }
+    }
+    
+    return !cpus->empty();
+}
+
+
+std::vector<std::string> isolation::get_noise_warnings() const
+{
+    std::vector<std::string> warns;
+    std::string cpu_dir;
+    std::string val;
+    std::error_code err_code;
+    double loadavg;
+    long n_cpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+    
+    for (auto& x : cpus_)
+    {
+        cpu_dir = "/sys/devices/system/cpu/cpu" + std::to_string(x);
+        val = read_first_line(cpu_dir + "/cpufreq/scaling_governor");
+        
+        if (!val.empty() && val != "performance")
+        {
+            warns.push_back("cpu" + std::to_string(x) + " uses the " + val +
+                            " frequency governor instead of performance");
+        }
+    }
+    
+    if (::getloadavg(&loadavg, 1) == 1 && n_cpus > 0 && loadavg > 0.5 * n_cpus)
+    {
+        warns.push_back("the load average is " + std::to_string(loadavg).substr(0, 4) +
+                        " on " + std::to_string(n_cpus) + " cores");
+    }
+    
+    for (auto& x : std::filesystem::directory_iterator("/sys/class/thermal", err_code))
+    {
+        val = read_first_line((x.path() / "temp").string());
+        
+        if (x.path().filename().string().compare(0, 12, "thermal_zone") == 0 &&
+            !val.empty() && std::strtol(val.c_str(), nullptr, 10) >= 85000)
+        {
+            warns.push_back(x.path().filename().string() + " is at " +
+                            std::to_string(std::strtol(val.c_str(), nullptr, 10) / 1000) +
+                            " degrees Celsius");
+        }
+    }
+    
+    return warns;
+}
+
+
+std::vector<std::string> isolation::get_noise_notes() const
+{
+    std::vector<std::string> notes;
+    
+    if (read_first_line("/sys/devices/system/cpu/intel_pstate/no_turbo") == "0" ||
+        read_first_line("/sys/devices/system/cpu/cpufreq/boost") == "1")
+    {
+        notes.emplace_back("turbo boost is enabled, timings may vary with the temperature");
+    }
+    
+    return notes;
+}
+
+
+std::uint64_t isolation::get_throttle_count() const
+{
+    std::uint64_t cnt = 0;
+    std::string cpu_dir;
+    
+    for (auto& x : cpus_)
+    {
+        cpu_dir = "/sys/devices/system/cpu/cpu" + std::to_string(x) + "/thermal_throttle";
+        cnt += std::strtoull(read_first_line(cpu_dir + "/core_throttle_count").c_str(), nullptr,
+                             10);
+        cnt += std::strtoull(read_first_line(cpu_dir + "/package_throttle_count").c_str(), nullptr,
+                             10);
+    }
+    
+    return cnt;
+}
+
+
+std::string isolation::read_first_line(const std::string& fle_path)
+{
+    std::string line;
+    std::ifstream ifs(fle_path);
+    
+    std::getline(ifs, line);
+    
+    return line;
+}
+
+
+}
@@ -0,0 +1,85 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_ISOLATION_HPP
+#define RUNSOURCE_ISOLATION_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+
+
+namespace runsource {
+
+
+class isolation
+{
+public:
+    isolation();
+    
+    isolation(bool pin, std::vector<int> cpus, bool no_aslr, bool strict);
+    
+    bool is_enabled() const noexcept;
+    
+    bool enter();
+    
+    void apply() const;
+    
+    void leave();
+    
+    std::vector<std::string> get_settings() const;
+    
+    static bool parse_cpu_list(const std::string& str, std::vector<int>* cpus);
+
+private:
+    std::vector<std::string> get_noise_warnings() const;
+    
+    std::vector<std::string> get_noise_notes() const;
+    
+    std::uint64_t get_throttle_count() const;
+    
+    static std::string read_first_line(const std::string& fle_path);
+
+private:
+    bool pin_;
+    
+    std::vector<int> cpus_;
+    
+    bool no_aslr_;
+    
+    bool strict_;
+    
+    bool entered_;
+    
+    cpu_set_t cpu_set_;
+    
+    cpu_set_t prev_cpu_set_;
+    
+    bool prev_cpu_set_vld_;
+    
+    std::uint64_t throttle_cnt_;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,120 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "job_pool.hpp"
+
+
+namespace runsource {
+
+
+job_pool::job_pool(std::size_t max_jobs)
+        : jobs_()
+        , max_jobs_(max_jobs == 0 ? get_default_size() : max_jobs)
+{
+}
+
+
+void job_pool::push(std::function<int()> jb)
+{
+    jobs_.push_back(std::move(jb));
+}
+
+
+int job_pool::run()
+{
+    std::vector<int> results(jobs_.size(), 0);
+    std::vector<std::thread> workrs;
+    std::atomic<std::size_t> nxt_job(0);
+    std::atomic<bool> failed(false);
+    std::size_t n_workrs = std::min(max_jobs_, jobs_.size());
+    auto work = [&]() {
+        std::size_t i;
+        
+        while (!failed && (i = nxt_job++) < jobs_.size())
+        {
+            results[i] = jobs_[i]();
+            
+            if (results[i] != 0)
+            {
+                failed = true;
+            }
+        }
+    };
+    
+    if (n_workrs <= 1)
+    {
+        work();
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n_workrs; i++)
+        {
+            workrs.emplace_back(work);
+        }
+        
+        for (auto& x : workrs)
+        {
+            x.join();
+        }
+    }
+    
+    jobs_.clear();
+    
+    for (auto& x : results)
+    {
+        if (x != 0)
+        {
+            return x;
+        }
+    }
+    
+    return 0;
+}
+
+
+std::size_t job_pool::get_default_size()
+{
+    constexpr std::size_t mem_per_job_kib = 512 * 1024;
+    std::size_t n_jobs = std::max(std::thread::hardware_concurrency(), 1u);
+    std::ifstream ifs("/proc/meminfo");
+    std::string ky;
+    std::size_t val;
+    
+    while (ifs >> ky >> val)
+    {
+        if (ky == "MemAvailable:")
+        {
+            n_jobs = std::clamp<std::size_t>(val / mem_per_job_kib, 1, n_jobs);
+            break;
+        }
+        
+        ifs.ignore(256, '\n');
+    }
+    
+    return n_jobs;
+}
+
+
+}
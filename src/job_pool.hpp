@@ -0,0 +1,52 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_JOB_POOL_HPP
+#define RUNSOURCE_JOB_POOL_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+
+namespace runsource {
+
+
+class job_pool
+{
+public:
+    explicit job_pool(std::size_t max_jobs);
+    
+    void push(std::function<int()> jb);
+    
+    int run();
+    
+    static std::size_t get_default_size();
+
+private:
+    std::vector<std::function<int()>> jobs_;
+    
+    std::size_t max_jobs_;
+};
+
+
+}
+
+
+#endif
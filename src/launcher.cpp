@@ -0,0 +1,724 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "launcher.hpp"
+
+extern char** environ;
+
+
+namespace runsource {
+
+
+static std::mutex cancel_mtx;
+
+
+static std::set<pid_t> cancellable_pids;
+
+
+static bool cancellation_enabled = false;
+
+
+static bool cancelled = false;
+
+
+static constexpr int bench_fd_num = 3;
+
+
+static constexpr const char* bench_fd_var = "RUNSOURCE_BENCH_FD=";
+
+
+static int spawn(
+        const std::vector<std::string>& args,
+        pid_t* pid,
+        const std::string& out_path = std::string(),
+        const std::string& err_path = std::string(),
+        const std::string& wrk_dir = std::string(),
+        bool own_grp = false
+)
+{
+    std::vector<char*> argv;
+    posix_spawn_file_actions_t fle_actns;
+    posix_spawnattr_t attr;
+    int err;
+    
+    for (auto& x : args)
+    {
+        argv.push_back(const_cast<char*>(x.c_str()));
+    }
+    
+    argv.push_back(nullptr);
+    
+    ::posix_spawn_file_actions_init(&fle_actns);
+    
+    if (!out_path.empty())
+    {
+        ::posix_spawn_file_actions_addopen(&fle_actns, STDOUT_FILENO, out_path.c_str(),
+                                           O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    
+    if (!err_path.empty() && err_path == out_path)
+    {
+        ::posix_spawn_file_actions_adddup2(&fle_actns, STDOUT_FILENO, STDERR_FILENO);
+    }
+    else if (!err_path.empty())
+    {
+        ::posix_spawn_file_actions_addopen(&fle_actns, STDERR_FILENO, err_path.c_str(),
+                                           O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    
+    if (!wrk_dir.empty())
+    {
+        ::posix_spawn_file_actions_addchdir_np(&fle_actns, wrk_dir.c_str());
+    }
+    
+    ::posix_spawnattr_init(&attr);
+    
+    if (own_grp)
+    {
+        ::posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+        ::posix_spawnattr_setpgroup(&attr, 0);
+    }
+    
+    err = ::posix_spawnp(pid, argv.front(), &fle_actns, &attr, argv.data(), environ);
+    ::posix_spawnattr_destroy(&attr);
+    ::posix_spawn_file_actions_destroy(&fle_actns);
+    
+    if (err != 0)
+    {
+        std::cerr << "runsource: " << args.front() << ": " << std::strerror(err) << spd::ios::newl;
+    }
+    
+    return err;
+}
+
+
+struct reap_report
+{
+    pid_t pid;
+    
+    int status;
+    
+    std::int64_t end_tme;
+    
+    rusage usage;
+};
+
+
+static std::int64_t get_monotonic_time()
+{
+    timespec ts;
+    
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+
+static bool write_fully(int fd, const void* buf, std::size_t sze)
+{
+    ssize_t n;
+    
+    while ((n = ::write(fd, buf, sze)) < 0 && errno == EINTR)
+    {
+    }
+    
+    return n == static_cast<ssize_t>(sze);
+}
+
+
+static bool read_fully(int fd, void* buf, std::size_t sze)
+{
+    ssize_t n;
+    
+    while ((n = ::read(fd, buf, sze)) < 0 && errno == EINTR)
+    {
+    }
+    
+    return n == static_cast<ssize_t>(sze);
+}
+
+
+[[noreturn]] static void exit_child(int err_fd)
+{
+    int err = errno;
+    
+    write_fully(err_fd, &err, sizeof(err));
+    ::_exit(127);
+}
+
+
+[[noreturn]] static void exec_gated(
+        char* const* argv,
+        char* const* envp,
+        int gate_fd,
+        int err_fd,
+        const std::string& out_path,
+        const std::string& wrk_dir,
+        const isolation* isoltn,
+        int bench_fd
+)
+{
+    char go;
+    int fd;
+    
+    if (!read_fully(gate_fd, &go, 1))
+    {
+        ::_exit(127);
+    }
+    
+    if (!out_path.empty())
+    {
+        fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        
+        if (fd < 0 || ::dup2(fd, STDOUT_FILENO) < 0 || ::dup2(fd, STDERR_FILENO) < 0)
+        {
+            exit_child(err_fd);
+        }
+    }
+    
+    if (bench_fd >= 0 && err_fd == bench_fd_num)
+    {
+        err_fd = ::fcntl(err_fd, F_DUPFD_CLOEXEC, bench_fd_num + 1);
+    }
+    
+    if (bench_fd == bench_fd_num)
+    {
+        ::fcntl(bench_fd, F_SETFD, 0);
+    }
+    else if (bench_fd >= 0 && ::dup2(bench_fd, bench_fd_num) < 0)
+    {
+        exit_child(err_fd);
+    }
+    
+    if (!wrk_dir.empty() && ::chdir(wrk_dir.c_str()) != 0)
+    {
+        exit_child(err_fd);
+    }
+    
+    if (isoltn != nullptr)
+    {
+        isoltn->apply();
+    }
+    
+    ::execvpe(argv[0], argv, envp);
+    exit_child(err_fd);
+}
+
+
+[[noreturn]] static void trace_tree(
+        char* const* argv,
+        char* const* envp,
+        const int* fds,
+        const std::string& out_path,
+        const std::string& wrk_dir,
+        const isolation* isoltn,
+        int bench_fd
+)
+{
+    reap_report rep;
+    pid_t pid;
+    
+    ::prctl(PR_SET_CHILD_SUBREAPER, 1);
+    
+    pid = ::fork();
+    
+    if (pid == 0)
+    {
+        exec_gated(argv, envp, fds[0], fds[1], out_path, wrk_dir, isoltn, bench_fd);
+    }
+    
+    if (pid < 0)
+    {
+        exit_child(fds[1]);
+    }
+    
+    ::close(fds[0]);
+    ::close(fds[1]);
+    
+    if (!write_fully(fds[2], &pid, sizeof(pid)))
+    {
+        ::_exit(127);
+    }
+    
+    while (true)
+    {
+        rep.pid = ::wait4(-1, &rep.status, 0, &rep.usage);
+        
+        if (rep.pid < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        
+        if (rep.pid < 0)
+        {
+            break;
+        }
+        
+        rep.end_tme = get_monotonic_time();
+        
+        if (!write_fully(fds[2], &rep, sizeof(rep)))
+        {
+            break;
+        }
+    }
+    
+    ::_exit(0);
+}
+
+
+static int fork_tracer(
+        const std::vector<std::string>& args,
+        pid_t* tracr_pid,
+        int* fds,
+        const std::string& out_path,
+        const std::string& wrk_dir,
+        const isolation* isoltn,
+        int bench_fd,
+        bool own_grp
+)
+{
+    std::string bench_var = bench_fd_var + std::to_string(bench_fd_num);
+    std::vector<char*> argv;
+    std::vector<char*> envp;
+    int gate_fds[2] = {-1, -1};
+    int err_fds[2] = {-1, -1};
+    int rep_fds[2] = {-1, -1};
+    int tracr_fds[3];
+    int err = 0;
+    
+    for (auto& x : args)
+    {
+        argv.push_back(const_cast<char*>(x.c_str()));
+    }
+    
+    argv.push_back(nullptr);
+    
+    for (char** x = environ; *x != nullptr; x++)
+    {
+        if (bench_fd < 0 || std::strncmp(*x, bench_fd_var, std::strlen(bench_fd_var)) != 0)
+        {
+            envp.push_back(*x);
+        }
+    }
+    
+    if (bench_fd >= 0)
+    {
+        envp.push_back(&bench_var[0]);
+    }
+    
+    envp.push_back(nullptr);
+    
+    if (::pipe2(gate_fds, O_CLOEXEC) != 0 || ::pipe2(err_fds, O_CLOEXEC) != 0 ||
+        ::pipe2(rep_fds, O_CLOEXEC) != 0)
+    {
+        err = errno;
+    }
+    else
+    {
+        tracr_fds[0] = gate_fds[0];
+        tracr_fds[1] = err_fds[1];
+        tracr_fds[2] = rep_fds[1];
+        
+        *tracr_pid = ::fork();
+        
+        if (*tracr_pid == 0 && own_grp)
+        {
+            ::setpgid(0, 0);
+        }
+        
+        if (*tracr_pid == 0)
+        {
+            trace_tree(argv.data(), envp.data(), tracr_fds, out_path, wrk_dir, isoltn, bench_fd);
+        }
+        
+        if (*tracr_pid < 0)
+        {
+            err = errno;
+        }
+        else if (own_grp)
+        {
+            ::setpgid(*tracr_pid, *tracr_pid);
+        }
+    }
+    
+    for (int x : {gate_fds[0], err_fds[1], rep_fds[1]})
+    {
+        if (x >= 0)
+        {
+            ::close(x);
+        }
+    }
+    
+    fds[0] = gate_fds[1];
+    fds[1] = err_fds[0];
+    fds[2] = rep_fds[0];
+    
+    if (err != 0)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            if (fds[i] >= 0)
+            {
+                ::close(fds[i]);
+            }
+        }
+    }
+    
+    return err;
+}
+
+
+static int open_gate(int* fds)
+{
+    int err = 0;
+    
+    if (!write_fully(fds[0], "x", 1))
+    {
+        err = errno;
+    }
+    
+    ::close(fds[0]);
+    
+    if (err == 0 && !read_fully(fds[1], &err, sizeof(err)))
+    {
+        err = 0;
+    }
+    
+    ::close(fds[1]);
+    
+    return err;
+}
+
+
+static int get_exit_code(int status)
+{
+    return WIFEXITED(status) ? WEXITSTATUS(status) :
+           WIFSIGNALED(status) ? 128 + WTERMSIG(status) :
+           -1;
+}
+
+
+static void add_resource_usage(const rusage& usage, run_sample* sample)
+{
+    sample->usr_tme += usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+    sample->sys_tme += usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    sample->peak_rss_kib = std::max(sample->peak_rss_kib, usage.ru_maxrss);
+    sample->minor_faults += usage.ru_minflt;
+    sample->major_faults += usage.ru_majflt;
+    sample->vol_ctx_switches += usage.ru_nvcsw;
+    sample->invol_ctx_switches += usage.ru_nivcsw;
+    sample->blk_reads += usage.ru_inblock;
+    sample->blk_writes += usage.ru_oublock;
+}
+
+
+std::vector<std::string> split_arguments(const std::string& str)
+{
+    std::vector<std::string> args;
+    std::string arg;
+    bool in_arg = false;
+    char quote = '\0';
+    
+    for (std::size_t i = 0; i < str.size(); i++)
+    {
+        if (quote == '\'')
+        {
+            if (str[i] == '\'')
+            {
+                quote = '\0';
+            }
+            else
+            {
+                arg += str[i];
+            }
+        }
+        else if (quote == '"')
+        {
+            if (str[i] == '"')
+            {
+                quote = '\0';
+            }
+            else if (str[i] == '\\' && i + 1 < str.size() &&
+                     std::strchr("\"\\$`", str[i + 1]) != nullptr)
+            {
+                arg += str[++i];
+            }
+            else
+            {
+                arg += str[i];
+            }
+        }
+        else if (str[i] == '\'' || str[i] == '"')
+        {
+            quote = str[i];
+            in_arg = true;
+        }
+        else if (str[i] == '\\' && i + 1 < str.size())
+        {
+            arg += str[++i];
+            in_arg = true;
+        }
+        else if (str[i] == ' ' || str[i] == '\t' || str[i] == '\n')
+        {
+            if (in_arg)
+            {
+                args.push_back(std::move(arg));
+                arg.clear();
+                in_arg = false;
+            }
+        }
+        else
+        {
+            arg += str[i];
+            in_arg = true;
+        }
+    }
+    
+    if (in_arg)
+    {
+        args.push_back(std::move(arg));
+    }
+    
+    return args;
+}
+
+
+std::string join_arguments(const std::vector<std::string>& args)
+{
+    std::string str;
+    
+    for (auto& x : args)
+    {
+        if (!str.empty())
+        {
+            str += ' ';
+        }
+        
+        if (!x.empty() && x.find_first_of(" \t\n'\"\\$`*?;&|<>()") == std::string::npos)
+        {
+            str += x;
+            continue;
+        }
+        
+        str += '\'';
+        
+        for (auto& ch : x)
+        {
+            if (ch == '\'')
+            {
+                str += "'\\''";
+            }
+            else
+            {
+                str += ch;
+            }
+        }
+        
+        str += '\'';
+    }
+    
+    return str;
+}
+
+
+int run_process(const std::vector<std::string>& args, const std::string& err_path)
+{
+    pid_t pid;
+    pid_t waited_pid;
+    int status;
+    std::unique_lock<std::mutex> lock(cancel_mtx);
+    
+    if (args.empty() || cancelled ||
+        spawn(args, &pid, std::string(), err_path, std::string(), cancellation_enabled) != 0)
+    {
+        return -1;
+    }
+    
+    if (cancellation_enabled)
+    {
+        cancellable_pids.insert(pid);
+    }
+    
+    lock.unlock();
+    
+    while ((waited_pid = ::waitpid(pid, &status, 0)) < 0 && errno == EINTR)
+    {
+    }
+    
+    lock.lock();
+    cancellable_pids.erase(pid);
+    
+    return waited_pid == pid ? get_exit_code(status) : -1;
+}
+
+
+void enable_cancellation()
+{
+    std::lock_guard<std::mutex> lock(cancel_mtx);
+    
+    cancellation_enabled = true;
+}
+
+
+void cancel_processes()
+{
+    std::lock_guard<std::mutex> lock(cancel_mtx);
+    
+    cancelled = true;
+    
+    for (auto& x : cancellable_pids)
+    {
+        ::kill(-x, SIGKILL);
+    }
+}
+
+
+void resume_processes()
+{
+    std::lock_guard<std::mutex> lock(cancel_mtx);
+    
+    cancelled = false;
+}
+
+
+int launch(
+        const std::vector<std::string>& args,
+        perf_counters* countrs,
+        run_sample* sample,
+        const std::string& out_path,
+        const std::string& wrk_dir,
+        const isolation* isoltn,
+        int bench_fd
+)
+{
+    std::int64_t start_tme = 0;
+    pid_t tracr_pid = -1;
+    pid_t pid = -1;
+    int fds[3];
+    int status;
+    int err;
+    reap_report rep;
+    std::unique_lock<std::mutex> lock(cancel_mtx);
+    
+    *sample = run_sample();
+    sample->exit_code = -1;
+    
+    if (args.empty() || cancelled)
+    {
+        return -1;
+    }
+    
+    err = fork_tracer(args, &tracr_pid, fds, out_path, wrk_dir, isoltn, bench_fd,
+                      cancellation_enabled);
+    if (err != 0)
+    {
+        std::cerr << "runsource: " << args.front() << ": " << std::strerror(err) << spd::ios::newl;
+        return -1;
+    }
+    
+    if (cancellation_enabled)
+    {
+        cancellable_pids.insert(tracr_pid);
+    }
+    
+    lock.unlock();
+    
+    if (!read_fully(fds[2], &pid, sizeof(pid)))
+    {
+        ::close(fds[0]);
+        err = read_fully(fds[1], &err, sizeof(err)) ? err : ECHILD;
+        ::close(fds[1]);
+    }
+    else
+    {
+        if (countrs != nullptr)
+        {
+            countrs->attach(pid);
+        }
+        
+        start_tme = get_monotonic_time();
+        err = open_gate(fds);
+    }
+    
+    while (err == 0 && read_fully(fds[2], &rep, sizeof(rep)))
+    {
+        add_resource_usage(rep.usage, sample);
+        
+        if (rep.pid == pid)
+        {
+            sample->wall_tme = (rep.end_tme - start_tme) / 1e9;
+            sample->exit_code = get_exit_code(rep.status);
+        }
+    }
+    
+    ::close(fds[2]);
+    
+    while (::waitpid(tracr_pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+    
+    lock.lock();
+    cancellable_pids.erase(tracr_pid);
+    
+    if (cancelled)
+    {
+        return -1;
+    }
+    
+    lock.unlock();
+    
+    if (err != 0)
+    {
+        std::cerr << "runsource: " << args.front() << ": " << std::strerror(err) << spd::ios::newl;
+        return -1;
+    }
+    
+    if (countrs != nullptr)
+    {
+        sample->countrs = countrs->read();
+    }
+    
+    sample->cpu_tme = sample->usr_tme + sample->sys_tme;
+    
+    return sample->exit_code;
+}
+
+
+}
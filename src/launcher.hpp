@@ -0,0 +1,66 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_LAUNCHER_HPP
+#define RUNSOURCE_LAUNCHER_HPP
+
+#include <string>
+#include <vector>
+
+#include "isolation.hpp"
+#include "perf_counters.hpp"
+#include "run_sample.hpp"
+
+
+namespace runsource {
+
+
+std::vector<std::string> split_arguments(const std::string& str);
+
+
+std::string join_arguments(const std::vector<std::string>& args);
+
+
+int run_process(const std::vector<std::string>& args, const std::string& err_path = std::string());
+
+
+void enable_cancellation();
+
+
+void cancel_processes();
+
+
+void resume_processes();
+
+
+int launch(
+        const std::vector<std::string>& args,
+        perf_counters* countrs,
+        run_sample* sample,
+        const std::string& out_path = std::string(),
+        const std::string& wrk_dir = std::string(),
+        const isolation* isoltn = nullptr,
+        int bench_fd = -1
+);
+
+
+}
+
+
+#endif
@@ -17,17 +17,39 @@
  * along with runsource. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <filesystem>
+#include <iostream>
 
 #include <speed/speed.hpp>
 #include <speed/speed_alias.hpp>
 
+#include "build_cache.hpp"
+#include "daemon.hpp"
+#include "environment.hpp"
+#include "history.hpp"
+#include "isolation.hpp"
+#include "output_capture.hpp"
 #include "program.hpp"
 
 namespace rs = runsource;
 
 
-int main(int argc, char *argv[])
+static bool is_forwardable(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--no-daemon") == 0 || std::strcmp(argv[i], "--watch") == 0)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+static int run(int argc, char *argv[])
 {
     int res;
     
@@ -44,7 +66,72 @@ int main(int argc, char *argv[])
     ap.add_key_arg({"--pause", "-p"}, "Pause the program before exit.");
     ap.add_key_arg({"--monotonic-chrono", "-mc"}, "Use a monotonic chrono.");
     ap.add_key_arg({"--cpu-chrono", "-cpu"}, "Use the process chrono.");
+    ap.add_key_value_arg({"--repeat", "-r"},
+                         "Run the produced program the specified number of times.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_value_arg({"--warmup", "-w"},
+                         "Run the produced program the specified number of times before measuring.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_value_arg({"--adaptive"},
+                         "Keep repeating until the 95% confidence interval of the mean is within "
+                         "the specified percentage.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--counters"}, "Report the performance counters of the produced program.");
+    ap.add_key_arg({"--resource-usage", "-ru"},
+                   "Report the resources used by the produced program and its descendants.");
+    ap.add_key_arg({"--calibrate"},
+                   "Subtract the startup time of an empty program of the same kind and report "
+                   "the clock resolution and the timer overhead.");
+    ap.add_key_value_arg({"--capture"},
+                         "Capture the output of the produced program instead of printing it, "
+                         "either discard, count, tail, tail:LINES or file:PATH.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_value_arg({"--matrix", "-m"},
+                         "Build and benchmark each specified variant of compiler arguments and "
+                         "standard options against the first one.",
+                         {spd::ap::avt_t::STRING}, 1u, ~0u);
+    ap.add_key_arg({"--pgo"},
+                   "Build an instrumented program, train it, rebuild it with the collected "
+                   "profile and benchmark it against the plain optimized build.");
+    ap.add_key_value_arg({"--training-args"},
+                         "Forward the folowing arguments to the program during the --pgo "
+                         "training run instead of the --program-args.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--batch"},
+                   "Build and run each file, or each source under a directory, as a separate "
+                   "program.");
+    ap.add_key_arg({"--serial"},
+                   "Run the batch programs one at a time instead of in parallel.");
+    ap.add_key_arg({"--isolate"},
+                   "Pin the produced program to a single core, raise its priority and check the "
+                   "system for sources of noise before measuring.");
+    ap.add_key_value_arg({"--cpus"},
+                         "Pin the produced program to the specified list of cores, like 2,3 or "
+                         "2-5.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--no-aslr"},
+                   "Disable the address space layout randomization of the produced program.");
+    ap.add_key_arg({"--strict"}, "Refuse to measure when the system is too noisy.");
+    ap.add_key_arg({"--watch"},
+                   "Rebuild and rerun the sources each time they or their local headers change.");
+    ap.add_key_value_arg({"--format", "-f"},
+                         "Write a machine readable record of the execution to the standard "
+                         "output after the report, either json or csv.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_value_arg({"--output", "-o"},
+                         "Append the machine readable record to the specified file.",
+                         {spd::ap::avt_t::STRING});
     ap.add_key_arg({"--gcc"}, "Use gcc tool chain for C and C++.");
+    ap.add_key_arg({"--clang"}, "Use clang tool chain for C and C++.");
+    ap.add_key_value_arg({"--stdlib"},
+                         "C++ standard library to use with clang, either libstdc++ or libc++.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_value_arg({"--linker"},
+                         "Linker to use, either auto, bfd, gold, lld or mold. auto picks the "
+                         "fastest one installed.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--compare-toolchains"},
+                   "Build and benchmark the sources with every installed tool chain.");
     ap.add_key_arg({"--c"}, "Force C language interpretation.");
     ap.add_key_arg({"--c++"}, "Force C++ language interpretation.");
     ap.add_key_arg({"--bash"}, "Force bash language interpretation.");
@@ -60,13 +147,33 @@ int main(int argc, char *argv[])
     ap.add_key_arg({"--c++17"}, "Use C++17 standard when C++ language is selected.");
     ap.add_key_arg({"--c++20"}, "Use C++20 standard when C++ language is selected.");
     ap.add_key_arg({"--optimize"}, "Use the maximum optimization level available.");
+    ap.add_key_value_arg({"--jobs", "-j"},
+                         "Number of files to compile in parallel, by default the number of cores.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--pch"}, "Precompile the leading system includes of the sources.");
+    ap.add_key_arg({"--unity"},
+                   "Compile the sources as a single translation unit, renaming the colliding "
+                   "internal names.");
+    ap.add_key_arg({"--lto"}, "Build with link-time optimization using parallel partitions.");
+    ap.add_key_arg({"--build-profile"},
+                   "Break the build time down into phases and rank the most expensive headers.");
+    ap.add_key_arg({"--no-cache"}, "Do not use the binary cache.");
+    ap.add_key_value_arg({"--cache-size"},
+                         "Maximum size of the binary cache in MiB.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--cache-stats"}, "Display the binary cache statistics.");
+    ap.add_key_value_arg({"--history"},
+                         "Display how the performance of the specified source changed over the "
+                         "recorded runs.",
+                         {spd::ap::avt_t::STRING});
+    ap.add_key_arg({"--no-daemon"}, "Do not forward the request to a running runsourced.");
     ap.add_help_arg({"--help"}, "Display this help and exit.");
     ap.add_gplv3_version_arg({"--version"}, "Output version information and exit", "1.0.0", "2017",
                              "Killian Valverde");
-    ap.add_keyless_arg("FILE", "File", "", {spd::ap::avt_t::R_FILE}, 1u, ~0u);
+    ap.add_keyless_arg("FILE", "File", "", {spd::ap::avt_t::STRING}, 0u, ~0u);
     ap.add_help_text("");
     ap.add_help_text("The folowind options are set by defautl: --exec --monotonic-chrono --gcc "
-                             "--c11 --c++17",
+                             "--c11 --c++17 --cache-size 1024 --linker auto",
                      {"--help"});
     
     ap.parse_args((unsigned int)argc, argv);
@@ -92,19 +199,155 @@ int main(int argc, char *argv[])
                                rs::cpp_standard::CPP17;
     
     rs::tool_chain tool_chn = ap.arg_found("--gcc") ? rs::tool_chain::GCC :
+                              ap.arg_found("--clang") ? rs::tool_chain::CLANG :
                               rs::tool_chain::GCC;
     
+    std::string stdlib = ap.get_front_arg_value_as<std::string>("--stdlib", "");
+    
+    std::string linker = ap.get_front_arg_value_as<std::string>("--linker", "auto");
+    
+    std::uintmax_t cache_max_sze = ap.get_front_arg_value_as<std::uintmax_t>("--cache-size", 1024);
+    
+    std::vector<std::filesystem::path> fles = ap.get_arg_values_as<std::filesystem::path>("FILE");
+    
+    std::string capt = ap.get_front_arg_value_as<std::string>("--capture", "");
+    
+    std::string cpus_str = ap.get_front_arg_value_as<std::string>("--cpus", "");
+    
+    std::vector<int> cpus;
+    
+    std::string frmt = ap.get_front_arg_value_as<std::string>(
+            "--format", ap.arg_found("--output") ? "json" : "");
+    
+    if (!frmt.empty() && frmt != "json" && frmt != "csv")
+    {
+        std::cerr << "runsource: invalid format '" << frmt << "'" << spd::ios::newl
+                  << "Try 'runsource --help' for more information." << spd::ios::newl;
+        return -1;
+    }
+    
+    if (!rs::output_capture::is_valid_mode(capt))
+    {
+        std::cerr << "runsource: invalid capture mode '" << capt << "'" << spd::ios::newl
+                  << "Try 'runsource --help' for more information." << spd::ios::newl;
+        return -1;
+    }
+    
+    if (!stdlib.empty() && stdlib != "libstdc++" && stdlib != "libc++")
+    {
+        std::cerr << "runsource: invalid standard library '" << stdlib << "'" << spd::ios::newl
+                  << "Try 'runsource --help' for more information." << spd::ios::newl;
+        return -1;
+    }
+    
+    if (linker != "auto" && linker != "bfd" && linker != "gold" && linker != "lld" &&
+        linker != "mold")
+    {
+        std::cerr << "runsource: invalid linker '" << linker << "'" << spd::ios::newl
+                  << "Try 'runsource --help' for more information." << spd::ios::newl;
+        return -1;
+    }
+    
+    if (!cpus_str.empty() && !rs::isolation::parse_cpu_list(cpus_str, &cpus))
+    {
+        std::cerr << "runsource: invalid list of cores '" << cpus_str << "'" << spd::ios::newl
+                  << "Try 'runsource --help' for more information." << spd::ios::newl;
+        return -1;
+    }
+    
+    if (ap.arg_found("--pgo") && (ap.arg_found("--matrix") || ap.arg_found("--compare-toolchains")))
+    {
+        std::cerr << "runsource: --pgo cannot be combined with --matrix or --compare-toolchains"
+                  << spd::ios::newl;
+        return -1;
+    }
+    
+    if (ap.arg_found("--watch") && ap.arg_found("--batch"))
+    {
+        std::cerr << "runsource: --watch cannot be combined with --batch" << spd::ios::newl;
+        return -1;
+    }
+    
+    if (ap.arg_found("--history"))
+    {
+        rs::print_history(
+                std::cout,
+                rs::read_history(rs::get_cache_path() / "history.log"),
+                std::filesystem::absolute(ap.get_front_arg_value_as<std::string>("--history", ""))
+                        .lexically_normal());
+        
+        if (fles.empty() && !ap.arg_found("--cache-stats"))
+        {
+            return 0;
+        }
+    }
+    
+    if (ap.arg_found("--cache-stats"))
+    {
+        rs::build_cache(rs::get_cache_path(), cache_max_sze * 1048576).print_stats(std::cout);
+        
+        if (fles.empty())
+        {
+            return 0;
+        }
+    }
+    
+    if (fles.empty())
+    {
+        std::cerr << "runsource: missing FILE operand" << spd::ios::newl
+                  << "Try 'runsource --help' for more information." << spd::ios::newl;
+        return -1;
+    }
+    
+    for (auto& x : fles)
+    {
+        if (!std::filesystem::exists(x) ||
+            (!ap.arg_found("--batch") && std::filesystem::is_directory(x)))
+        {
+            std::cerr << "runsource: cannot access '" << x.string() << "'" << spd::ios::newl
+                      << "Try 'runsource --help' for more information." << spd::ios::newl;
+            return -1;
+        }
+    }
+    
     rs::program prog(
             !ap.arg_found("--build"),
             lang,
             c_std,
             cpp_std,
-            ap.arg_found("--optimize"),
+            ap.arg_found("--optimize") || ap.arg_found("--pgo"),
             tool_chn,
+            std::move(stdlib),
+            std::move(linker),
             ap.get_front_arg_value_as<std::string>("--compiler-args", ""),
             ap.get_front_arg_value_as<std::string>("--program-args", ""),
             ap.arg_found("--monotonic-chrono"),
-            ap.get_arg_values_as<std::filesystem::path>("FILE")
+            !ap.arg_found("--no-cache"),
+            cache_max_sze * 1048576,
+            ap.get_front_arg_value_as<std::size_t>("--jobs", 0),
+            ap.arg_found("--pch"),
+            ap.arg_found("--unity"),
+            ap.arg_found("--lto"),
+            ap.arg_found("--build-profile"),
+            ap.get_front_arg_value_as<std::size_t>("--repeat", 1),
+            ap.get_front_arg_value_as<std::size_t>("--warmup", 0),
+            ap.get_front_arg_value_as<double>("--adaptive", 0),
+            ap.arg_found("--counters"),
+            ap.arg_found("--resource-usage"),
+            std::move(capt),
+            ap.arg_found("--calibrate"),
+            ap.get_arg_values_as<std::string>("--matrix"),
+            ap.arg_found("--compare-toolchains"),
+            ap.arg_found("--pgo"),
+            ap.get_front_arg_value_as<std::string>("--training-args", ""),
+            ap.arg_found("--batch"),
+            ap.arg_found("--serial"),
+            ap.arg_found("--watch"),
+            rs::isolation(ap.arg_found("--isolate") || ap.arg_found("--strict"), std::move(cpus),
+                          ap.arg_found("--no-aslr"), ap.arg_found("--strict")),
+            std::move(frmt),
+            ap.get_front_arg_value_as<std::string>("--output", ""),
+            std::move(fles)
     );
     
     res = prog.execute();
@@ -116,3 +359,27 @@ int main(int argc, char *argv[])
     
     return res;
 }
+
+
+int main(int argc, char *argv[])
+{
+    int res;
+    
+    if (std::filesystem::path(argv[0]).filename() == "runsourced")
+    {
+        for (auto& x : {"gcc", "g++", "clang", "clang++", "bash", "python", "ld.mold", "ld.lld",
+                        "ld.gold"})
+        {
+            rs::find_executable(x);
+        }
+        
+        return rs::serve_requests(rs::get_socket_path(), run);
+    }
+    
+    if (is_forwardable(argc, argv) && rs::forward_request(rs::get_socket_path(), argc, argv, &res))
+    {
+        return res;
+    }
+    
+    return run(argc, argv);
+}
@@ -0,0 +1,123 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "memory_file.hpp"
+
+
+namespace runsource {
+
+
+static std::map<std::string, int> memory_fles;
+
+
+static std::mutex memory_fles_mtx;
+
+
+std::string create_memory_file(const std::string& nme)
+{
+    std::string fle_path;
+    int fd = ::memfd_create(nme.c_str(), MFD_CLOEXEC);
+    
+    if (fd < 0)
+    {
+        return std::string();
+    }
+    
+    fle_path = "/proc/";
+    fle_path += std::to_string(::getpid());
+    fle_path += "/fd/";
+    fle_path += std::to_string(fd);
+    
+    std::lock_guard<std::mutex> lock(memory_fles_mtx);
+    memory_fles[fle_path] = fd;
+    
+    return fle_path;
+}
+
+
+bool is_memory_file(const std::string& fle_path)
+{
+    std::lock_guard<std::mutex> lock(memory_fles_mtx);
+    
+    return memory_fles.count(fle_path) != 0;
+}
+
+
+bool copy_to_memory_file(const std::string& src_path, const std::string& fle_path)
+{
+    std::unique_lock<std::mutex> lock(memory_fles_mtx);
+    auto it = memory_fles.find(fle_path);
+    int fd = it == memory_fles.end() ? -1 : it->second;
+    int src_fd;
+    struct stat src_stat;
+    off_t off = 0;
+    ssize_t n = 0;
+    
+    lock.unlock();
+    
+    if (fd < 0 || (src_fd = ::open(src_path.c_str(), O_RDONLY | O_CLOEXEC)) < 0)
+    {
+        return false;
+    }
+    
+    if (::fstat(src_fd, &src_stat) != 0 || ::ftruncate(fd, 0) != 0)
+    {
+        ::close(src_fd);
+        return false;
+    }
+    
+    while (off < src_stat.st_size && (n = ::sendfile(fd, src_fd, &off, src_stat.st_size - off)) > 0)
+    {
+    }
+    
+    ::close(src_fd);
+    
+    return off == src_stat.st_size && n >= 0;
+}
+
+
+void remove_output_file(const std::string& fle_path)
+{
+    std::unique_lock<std::mutex> lock(memory_fles_mtx);
+    auto it = memory_fles.find(fle_path);
+    
+    if (it != memory_fles.end())
+    {
+        ::close(it->second);
+        memory_fles.erase(it);
+        
+        return;
+    }
+    
+    lock.unlock();
+    std::remove(fle_path.c_str());
+}
+
+
+}
@@ -0,0 +1,44 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_MEMORY_FILE_HPP
+#define RUNSOURCE_MEMORY_FILE_HPP
+
+#include <string>
+
+
+namespace runsource {
+
+
+std::string create_memory_file(const std::string& nme);
+
+
+bool is_memory_file(const std::string& fle_path);
+
+
+bool copy_to_memory_file(const std::string& src_path, const std::string& fle_path);
+
+
+void remove_output_file(const std::string& fle_path);
+
+
+}
+
+
+#endif
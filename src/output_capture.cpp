@@ -0,0 +1,374 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "output_capture.hpp"
+
+
+namespace runsource {
+
+
+output_capture::output_capture(const std::string& mode)
+        : mode_(capture_mode::NIL)
+        , tail_lnes_(20)
+        , fle_path_()
+        , rd_fd_(-1)
+        , wr_fd_(-1)
+        , dst_fd_(-1)
+        , stop_fds_{-1, -1}
+        , thrd_()
+        , bytes_(0)
+        , lnes_(0)
+        , tail_()
+{
+    parse_mode(mode, &mode_, &tail_lnes_, &fle_path_);
+}
+
+
+output_capture::~output_capture()
+{
+    stop(nullptr);
+    
+    if (dst_fd_ >= 0)
+    {
+        ::close(dst_fd_);
+    }
+}
+
+
+bool output_capture::start()
+{
+    int fds[2];
+    
+    if (mode_ == capture_mode::NIL)
+    {
+        return true;
+    }
+    
+    if (dst_fd_ < 0 && mode_ == capture_mode::DISCARD)
+    {
+        dst_fd_ = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    }
+    else if (dst_fd_ < 0 && mode_ == capture_mode::FILE)
+    {
+        dst_fd_ = ::open(fle_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (dst_fd_ < 0)
+        {
+            std::cerr << "runsource: cannot open " << fle_path_ << spd::ios::newl;
+            return false;
+        }
+    }
+    
+    if (::pipe2(fds, O_CLOEXEC) != 0)
+    {
+        std::cerr << "runsource: cannot create the output pipe" << spd::ios::newl;
+        return false;
+    }
+    
+    if (::pipe2(stop_fds_, O_CLOEXEC) != 0)
+    {
+        std::cerr << "runsource: cannot create the output pipe" << spd::ios::newl;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return false;
+    }
+    
+    rd_fd_ = fds[0];
+    wr_fd_ = fds[1];
+    bytes_ = 0;
+    lnes_ = 0;
+    tail_.clear();
+    
+    ::fcntl(rd_fd_, F_SETFL, ::fcntl(rd_fd_, F_GETFL) | O_NONBLOCK);
+    
+    ::fcntl(rd_fd_, F_SETPIPE_SZ, static_cast<int>(buf_sze_));
+    
+    thrd_ = std::thread([this]() {
+        drain();
+    });
+    
+    return true;
+}
+
+
+void output_capture::stop(run_sample* sample)
+{
+    if (wr_fd_ < 0)
+    {
+        return;
+    }
+    
+    ::close(wr_fd_);
+    wr_fd_ = -1;
+    
+    while (::write(stop_fds_[1], "", 1) < 0 && errno == EINTR)
+    {
+    }
+    
+    thrd_.join();
+    ::close(rd_fd_);
+    ::close(stop_fds_[0]);
+    ::close(stop_fds_[1]);
+    rd_fd_ = -1;
+    stop_fds_[0] = -1;
+    stop_fds_[1] = -1;
+    
+    if (sample != nullptr)
+    {
+        sample->out_captured = true;
+        sample->out_bytes = bytes_;
+        sample->out_lnes = mode_ == capture_mode::COUNT || mode_ == capture_mode::TAIL ? lnes_ : -1;
+    }
+}
+
+
+std::string output_capture::get_out_path() const
+{
+    if (wr_fd_ < 0)
+    {
+        return std::string();
+    }
+    
+    return "/proc/" + std::to_string(spd::sys::proc::get_pid()) + "/fd/" + std::to_string(wr_fd_);
+}
+
+
+void output_capture::print_tail(std::ostream& os) const
+{
+    std::size_t beg = tail_.size();
+    std::size_t pos;
+    
+    if (mode_ != capture_mode::TAIL || tail_.empty())
+    {
+        return;
+    }
+    
+    beg -= tail_.back() == '\n' ? 1 : 0;
+    
+    for (std::size_t i = 0; i < tail_lnes_ && beg > 0; i++)
+    {
+        pos = tail_.rfind('\n', beg - 1);
+        beg = pos == std::string::npos ? 0 : pos;
+    }
+    
+    os << tail_.substr(beg == 0 && tail_.front() != '\n' ? 0 : beg + 1);
+    
+    if (tail_.back() != '\n')
+    {
+        os << spd::ios::newl;
+    }
+}
+
+
+bool output_capture::is_valid_mode(const std::string& mode)
+{
+    capture_mode capt_mode;
+    std::size_t tail_lnes;
+    std::string fle_path;
+    
+    return parse_mode(mode, &capt_mode, &tail_lnes, &fle_path);
+}
+
+
+void output_capture::drain()
+{
+    std::unique_ptr<char[]> buf = std::make_unique<char[]>(buf_sze_);
+    std::chrono::steady_clock::time_point deadln;
+    unsigned int splice_flgs = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+    bool use_splice = dst_fd_ >= 0;
+    bool stppd = false;
+    ssize_t len;
+    
+    while (wait_readable(&stppd, &deadln))
+    {
+        if (use_splice)
+        {
+            len = ::splice(rd_fd_, nullptr, dst_fd_, nullptr, buf_sze_, splice_flgs);
+            
+            if (len < 0 && errno == EINVAL && bytes_ == 0)
+            {
+                use_splice = false;
+                continue;
+            }
+            
+            bytes_ += len > 0 ? len : 0;
+        }
+        else
+        {
+            len = ::read(rd_fd_, buf.get(), buf_sze_);
+            
+            if (len > 0)
+            {
+                consume(buf.get(), len);
+            }
+            
+            if (len > 0 && dst_fd_ >= 0 && ::write(dst_fd_, buf.get(), len) != len)
+            {
+                std::cerr << "runsource: cannot write to " << fle_path_ << spd::ios::newl;
+                ::close(dst_fd_);
+                dst_fd_ = -1;
+            }
+        }
+        
+        if (len == 0 || (len < 0 && errno != EINTR && errno != EAGAIN))
+        {
+            return;
+        }
+    }
+}
+
+
+bool output_capture::wait_readable(bool* stppd, std::chrono::steady_clock::time_point* deadln)
+{
+    pollfd pfds[2] = {{rd_fd_, POLLIN, 0}, {stop_fds_[0], POLLIN, 0}};
+    std::chrono::milliseconds remng;
+    int tmeout = -1;
+    int res;
+    
+    if (*stppd)
+    {
+        remng = std::chrono::duration_cast<std::chrono::milliseconds>(
+                *deadln - std::chrono::steady_clock::now());
+        tmeout = static_cast<int>(remng.count());
+        
+        if (tmeout <= 0)
+        {
+            return false;
+        }
+    }
+    
+    res = ::poll(pfds, *stppd ? 1 : 2, tmeout);
+    
+    if (res < 0)
+    {
+        return errno == EINTR;
+    }
+    
+    if (res == 0)
+    {
+        return false;
+    }
+    
+    if (!*stppd && (pfds[1].revents & POLLIN) != 0)
+    {
+        *stppd = true;
+        *deadln = std::chrono::steady_clock::now() + std::chrono::milliseconds(drain_tmeout_);
+    }
+    
+    return true;
+}
+
+
+void output_capture::consume(const char* buf, std::size_t len)
+{
+    const char* cur = buf;
+    const char* end = buf + len;
+    
+    bytes_ += len;
+    
+    if (mode_ == capture_mode::FILE)
+    {
+        return;
+    }
+    
+    while ((cur = static_cast<const char*>(std::memchr(cur, '\n', end - cur))) != nullptr)
+    {
+        lnes_++;
+        cur++;
+    }
+    
+    if (mode_ != capture_mode::TAIL)
+    {
+        return;
+    }
+    
+    if (len >= max_tail_sze_)
+    {
+        tail_.assign(end - max_tail_sze_, end);
+        return;
+    }
+    
+    tail_.append(buf, len);
+    
+    if (tail_.size() > 2 * max_tail_sze_)
+    {
+        tail_.erase(0, tail_.size() - max_tail_sze_);
+    }
+}
+
+
+bool output_capture::parse_mode(
+        const std::string& mode,
+        capture_mode* capt_mode,
+        std::size_t* tail_lnes,
+        std::string* fle_path
+)
+{
+    char* end;
+    
+    if (mode.empty())
+    {
+        *capt_mode = capture_mode::NIL;
+    }
+    else if (mode == "discard")
+    {
+        *capt_mode = capture_mode::DISCARD;
+    }
+    else if (mode == "count")
+    {
+        *capt_mode = capture_mode::COUNT;
+    }
+    else if (mode == "tail")
+    {
+        *capt_mode = capture_mode::TAIL;
+    }
+    else if (mode.compare(0, 5, "tail:") == 0)
+    {
+        *capt_mode = capture_mode::TAIL;
+        *tail_lnes = std::strtoul(mode.c_str() + 5, &end, 10);
+        
+        return mode.size() > 5 && *end == '\0' && *tail_lnes > 0;
+    }
+    else if (mode.compare(0, 5, "file:") == 0 && mode.size() > 5)
+    {
+        *capt_mode = capture_mode::FILE;
+        *fle_path = mode.substr(5);
+    }
+    else
+    {
+        return false;
+    }
+    
+    return true;
+}
+
+
+}
@@ -0,0 +1,114 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_OUTPUT_CAPTURE_HPP
+#define RUNSOURCE_OUTPUT_CAPTURE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "run_sample.hpp"
+
+
+namespace runsource {
+
+
+enum class capture_mode
+{
+    NIL,
+    DISCARD,
+    COUNT,
+    TAIL,
+    FILE,
+};
+
+
+class output_capture
+{
+public:
+    explicit output_capture(const std::string& mode);
+    
+    output_capture(const output_capture& rhs) = delete;
+    
+    ~output_capture();
+    
+    output_capture& operator=(const output_capture& rhs) = delete;
+    
+    bool start();
+    
+    void stop(run_sample* sample);
+    
+    std::string get_out_path() const;
+    
+    void print_tail(std::ostream& os) const;
+    
+    static bool is_valid_mode(const std::string& mode);
+
+private:
+    void drain();
+    
+    bool wait_readable(bool* stppd, std::chrono::steady_clock::time_point* deadln);
+    
+    void consume(const char* buf, std::size_t len);
+    
+    static bool parse_mode(
+            const std::string& mode,
+            capture_mode* capt_mode,
+            std::size_t* tail_lnes,
+            std::string* fle_path
+    );
+
+private:
+    capture_mode mode_;
+    
+    std::size_t tail_lnes_;
+    
+    std::string fle_path_;
+    
+    int rd_fd_;
+    
+    int wr_fd_;
+    
+    int dst_fd_;
+    
+    int stop_fds_[2];
+    
+    std::thread thrd_;
+    
+    long bytes_;
+    
+    long lnes_;
+    
+    std::string tail_;
+    
+    static constexpr std::size_t max_tail_sze_ = 65536;
+    
+    static constexpr std::size_t buf_sze_ = 1048576;
+    
+    static constexpr int drain_tmeout_ = 1000;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,162 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "perf_counters.hpp"
+
+
+namespace runsource {
+
+
+struct event_info
+{
+    std::uint32_t typ;
+    
+    std::uint64_t config;
+    
+    const char* nme;
+};
+
+
+static const event_info events[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, "cache-references"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch-misses"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page-faults"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context-switches"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "cpu-migrations"},
+};
+
+
+perf_counters::perf_counters()
+        : fds_()
+{
+}
+
+
+perf_counters::~perf_counters()
+{
+    close_events();
+}
+
+
+void perf_counters::attach(pid_t pid)
+{
+    close_events();
+    
+    for (auto& x : events)
+    {
+        open_event(pid, x.typ, x.config, x.nme);
+    }
+}
+
+
+std::vector<std::string> perf_counters::get_event_names()
+{
+    std::vector<std::string> nmes;
+    
+    for (auto& x : events)
+    {
+        nmes.emplace_back(x.nme);
+    }
+    
+    return nmes;
+}
+
+
+std::vector<std::pair<std::string, double>> perf_counters::read() const
+{
+    std::vector<std::pair<std::string, double>> vals;
+    std::uint64_t buf[3];
+    double val;
+    
+    for (auto& x : fds_)
+    {
+        if (::read(x.first, buf, sizeof(buf)) != sizeof(buf))
+        {
+            continue;
+        }
+        
+        val = static_cast<double>(buf[0]);
+        
+        if (buf[2] != 0 && buf[2] < buf[1])
+        {
+            val *= static_cast<double>(buf[1]) / buf[2];
+        }
+        
+        vals.emplace_back(x.second, val);
+    }
+    
+    return vals;
+}
+
+
+void perf_counters::close_events()
+{
+    for (auto& x : fds_)
+    {
+        ::close(x.first);
+    }
+    
+    fds_.clear();
+}
+
+
+bool perf_counters::open_event(pid_t pid, std::uint32_t typ, std::uint64_t config, const char* nme)
+{
+    perf_event_attr attr;
+    long fd;
+    
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = typ;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    
+    fd = ::syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    
+    if (fd < 0)
+    {
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = ::syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+    }
+    
+    if (fd < 0)
+    {
+        return false;
+    }
+    
+    fds_.emplace_back(static_cast<int>(fd), nme);
+    
+    return true;
+}
+
+
+}
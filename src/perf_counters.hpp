@@ -0,0 +1,64 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_PERF_COUNTERS_HPP
+#define RUNSOURCE_PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+
+namespace runsource {
+
+
+class perf_counters
+{
+public:
+    perf_counters();
+    
+    perf_counters(const perf_counters& rhs) = delete;
+    
+    ~perf_counters();
+    
+    perf_counters& operator=(const perf_counters& rhs) = delete;
+    
+    void attach(pid_t pid);
+    
+    static std::vector<std::string> get_event_names();
+    
+    std::vector<std::pair<std::string, double>> read() const;
+
+private:
+    void close_events();
+    
+    bool open_event(pid_t pid, std::uint32_t typ, std::uint64_t config, const char* nme);
+
+private:
+    std::vector<std::pair<int, std::string>> fds_;
+};
+
+
+}
+
+
+#endif
@@ -21,20 +21,54 @@
 // Created by Killian Poulaud on 22/05/17.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
-#include <regex>
+#include <map>
+#include <memory>
+#include <thread>
 
 #include <speed/speed.hpp>
 #include <speed/speed_alias.hpp>
 
+#include "batch.hpp"
+#include "bench_channel.hpp"
+#include "benchmark.hpp"
+#include "build_cache.hpp"
+#include "calibration.hpp"
+#include "depfile.hpp"
+#include "directive_scanner.hpp"
+#include "environment.hpp"
+#include "hasher.hpp"
+#include "history.hpp"
+#include "job_pool.hpp"
+#include "launcher.hpp"
+#include "memory_file.hpp"
+#include "output_capture.hpp"
+#include "perf_counters.hpp"
 #include "program.hpp"
+#include "run_record.hpp"
+#include "statistics.hpp"
+#include "unity_build.hpp"
+#include "watcher.hpp"
 
 
 namespace runsource {
 
 
+static volatile std::sig_atomic_t watch_stop_sig = 0;
+
+
+static void stop_watching(int sig)
+{
+    watch_stop_sig = sig;
+}
+
+
 program::program(
         bool exec,
         language lang,
@@ -42,9 +76,35 @@ program::program(
         cpp_standard cpp_std,
         bool optmz,
         tool_chain tool_chn,
+        std::string stdlib,
+        std::string linker,
         std::string comp_args,
         std::string prog_args,
         bool monotonic_chrn,
+        bool cache,
+        std::uintmax_t cache_max_sze,
+        std::size_t jobs,
+        bool pch,
+        bool unity,
+        bool lto,
+        bool build_prof,
+        std::size_t repeat,
+        std::size_t warmup,
+        double precsn,
+        bool countrs,
+        bool rsrc_usage,
+        std::string capt,
+        bool calib,
+        std::vector<std::string> matrix,
+        bool cmp_tool_chns,
+        bool pgo,
+        std::string train_args,
+        bool batch,
+        bool serial,
+        bool watch,
+        isolation isoltn,
+        std::string frmt,
+        std::filesystem::path out_path,
         std::vector<std::filesystem::path> fles
 )
         : exec_(exec)
@@ -53,12 +113,49 @@ program::program(
         , cpp_std_(cpp_std)
         , optmz_(optmz)
         , tool_chn_(tool_chn)
+        , stdlib_(std::move(stdlib))
+        , linker_(std::move(linker))
         , comp_args_(std::move(comp_args))
         , prog_args_(std::move(prog_args))
         , monotonic_chrn_(monotonic_chrn)
+        , cache_(cache)
+        , cache_max_sze_(cache_max_sze)
+        , jobs_(jobs)
+        , pch_(pch)
+        , unity_(unity)
+        , lto_(lto)
+        , build_prof_(build_prof)
+        , repeat_(repeat)
+        , warmup_(warmup)
+        , precsn_(precsn)
+        , countrs_(countrs)
+        , rsrc_usage_(rsrc_usage)
+        , capt_(std::move(capt))
+        , calib_(calib)
+        , matrix_(std::move(matrix))
+        , cmp_tool_chns_(cmp_tool_chns)
+        , pgo_(pgo)
+        , train_args_(std::move(train_args))
+        , batch_(batch)
+        , serial_(serial)
+        , watch_(watch)
+        , isoltn_(std::move(isoltn))
+        , frmt_(std::move(frmt))
+        , out_path_(std::move(out_path))
         , fles_(std::move(fles))
+        , diag_path_()
 {
-    if (lang == language::NIL)
+    for (auto& x : fles_)
+    {
+        x = std::filesystem::absolute(x).lexically_normal();
+    }
+    
+    if (!out_path_.empty())
+    {
+        out_path_ = std::filesystem::absolute(out_path_);
+    }
+    
+    if (lang == language::NIL && !batch_)
     {
         lang_ = is_c() ? language::C :
                 is_cpp() ? language::CPP :
@@ -71,546 +168,2235 @@ program::program(
 
 int program::execute() const
 {
+    int result = -1;
+    
+    if (watch_)
+    {
+        return execute_watch();
+    }
+    
+    if (batch_)
+    {
+        return batch(get_batch_programs(), jobs_, serial_, isoltn_, repeat_, warmup_,
+                     monotonic_chrn_).execute();
+    }
+    
     spd::sys::fsys::chdir(fles_.front().parent_path().c_str());
     
+    init_record();
+    
+    if (pgo_)
+    {
+        return execute_pgo();
+    }
+    
+    if (!matrix_.empty() || cmp_tool_chns_)
+    {
+        return execute_comparison();
+    }
+    
     switch (lang_)
     {
         case language::C:
-            if (tool_chn_ == tool_chain::GCC)
+            if (tool_chn_ == tool_chain::GCC || tool_chn_ == tool_chain::CLANG)
             {
-                return exec_ ? gcc_execute_c() : gcc_build_c();
+                result = exec_ ? execute_c() : build_c();
             }
             break;
         
         case language::CPP:
-            if (tool_chn_ == tool_chain::GCC)
+            if (tool_chn_ == tool_chain::GCC || tool_chn_ == tool_chain::CLANG)
             {
-                return exec_ ? gcc_execute_cpp() : gcc_build_cpp();
+                result = exec_ ? execute_cpp() : build_cpp();
             }
             break;
         
         case language::BASH:
-            return execute_bash();
+            result = execute_bash();
+            break;
         
         case language::PYTHON:
-            return execute_python();
+            result = execute_python();
+            break;
     }
     
-    return -1;
-}
-
-
-bool program::is_c() const noexcept
-{
-    for (auto& x : fles_)
+    if (!frmt_.empty())
     {
-        if (c_exts_.count(x.extension()) == 0)
-        {
-            return false;
-        }
+        write_record();
     }
     
-    return true;
+    return result;
 }
 
 
-bool program::is_cpp() const noexcept
+int program::build(
+        std::vector<std::string>* args,
+        std::string* tmp_path,
+        const std::string& tmp_sfx
+) const
 {
-    for (auto& x : fles_)
+    std::vector<std::string> prog_args = split_arguments(prog_args_);
+    std::string out_nme;
+    bool out_is_tmp;
+    int result;
+    
+    args->clear();
+    tmp_path->clear();
+    init_record();
+    
+    switch (lang_)
     {
-        if (cpp_exts_.count(x.extension()) == 0)
-        {
-            return false;
-        }
+        case language::C:
+        case language::CPP:
+            if (tool_chn_ != tool_chain::GCC && tool_chn_ != tool_chain::CLANG)
+            {
+                return -1;
+            }
+            
+            result = build_executable(&out_nme, &out_is_tmp, tmp_sfx);
+            if (result != 0)
+            {
+                return result;
+            }
+            
+            args->push_back(out_nme);
+            
+            if (out_is_tmp)
+            {
+                *tmp_path = out_nme;
+            }
+            break;
+        
+        case language::BASH:
+        case language::PYTHON:
+            args->push_back(lang_ == language::BASH ? "bash" : "python");
+            
+            for (auto& x : fles_)
+            {
+                args->push_back(x.string());
+            }
+            break;
+        
+        default:
+            return -1;
     }
     
-    return true;
+    args->insert(args->end(), prog_args.begin(), prog_args.end());
+    
+    return 0;
 }
 
 
-bool program::is_bash() const noexcept
+const std::vector<std::filesystem::path>& program::get_files() const noexcept
 {
-    for (auto& x : fles_)
-    {
-        if (bash_exts_.count(x.extension()) == 0 && x.has_extension())
-        {
-            return false;
-        }
-    }
-    
-    return true;
+    return fles_;
 }
 
 
-bool program::is_python() const noexcept
+void program::set_diagnostics_path(std::string diag_path)
 {
-    for (auto& x : fles_)
-    {
-        if (python_exts_.count(x.extension()) == 0)
-        {
-            return false;
-        }
-    }
-    
-    return true;
+    diag_path_ = std::move(diag_path);
 }
 
 
-int program::gcc_build_c(const std::string& out_nme, bool verb) const
+int program::execute_comparison() const
 {
-    int result = -1;
-    std::string command = "gcc ";
-    std::unordered_set<std::string> libs_to_link;
-    spd::tm::monotonic_chrono monotonic_chrn;
-    
-    for (auto& x : fles_)
-    {
-        add_c_libs_to_link_from_file(x, libs_to_link);
-        
-        command += "\"";
-        command += x.string();
-        command += "\"";
-        command += ' ';
-    }
-    
-    command += "-o ";
-    command += "\"";
-    command += out_nme.empty() ? fles_.front().stem().string() : out_nme;
-    command += "\"";
-    command += ' ';
-    
-    if (!comp_args_.empty())
-    {
-        command += comp_args_;
-        command += ' ';
-    }
+    std::vector<tool_chain> tool_chns = {tool_chn_};
+    std::vector<std::string> mtrx = matrix_;
+    std::vector<program> variants;
+    std::vector<std::string> nmes;
     
-    for (auto& x : libs_to_link)
+    if (lang_ != language::C && lang_ != language::CPP)
     {
-        command += x;
-        command += ' ';
+        std::cerr << "runsource: --matrix and --compare-toolchains require C or C++ sources"
+                  << spd::ios::newl;
+        return -1;
     }
     
-    if (c_std_ != c_standard::NIL)
+    if (cmp_tool_chns_)
     {
-        if (c_std_ == c_standard::C89)
-        {
-            command += "-std=c89 ";
-        }
-        else if (c_std_ == c_standard::C90)
-        {
-            command += "-std=c90 ";
-        }
-        else if (c_std_ == c_standard::C99)
+        tool_chns.clear();
+        
+        for (auto& x : {tool_chain::GCC, tool_chain::CLANG})
         {
-            command += "-std=c99 ";
+            program prog = *this;
+            
+            prog.tool_chn_ = x;
+            if (!find_executable(prog.get_compiler_name()).empty())
+            {
+                tool_chns.push_back(x);
+            }
         }
-        else if (c_std_ == c_standard::C11)
+        
+        if (tool_chns.empty())
         {
-            command += "-std=c11 ";
+            std::cerr << "runsource: no tool chain found" << spd::ios::newl;
+            return -1;
         }
     }
     
-    if (optmz_)
+    if (mtrx.empty())
     {
-        command += "-O3 ";
+        mtrx.emplace_back();
     }
     
-    monotonic_chrn.start();
-    spd::sys::proc::execute_command(command.c_str(), &result);
-    monotonic_chrn.stop();
-    
-    if (verb && result == 0)
+    for (auto& x : tool_chns)
     {
-        std::cout << "C program build in "
-                  << std::setprecision(3)
-                  << std::fixed
-                  << monotonic_chrn
-                  << " seconds"
-                  << spd::ios::newl;
+        for (auto& y : mtrx)
+        {
+            variants.push_back(get_variant(y));
+            variants.back().tool_chn_ = x;
+            
+            nmes.push_back(cmp_tool_chns_ ? variants.back().get_tool_chain_name() : "");
+            nmes.back() += nmes.back().empty() || y.empty() ? "" : " ";
+            nmes.back() += y;
+        }
     }
     
-    return result;
+    return compare_variants(variants, nmes);
 }
 
 
-int program::gcc_execute_c() const
+int program::execute_pgo() const
 {
-    std::string output_name;
-    std::string command;
-    int build_result;
-    int exec_result = -1;
-    std::stringstream strstream;
-    std::string strstream_str;
-    spd::tm::monotonic_chrono monotonic_chrn;
-    spd::tm::child_cpu_chrono cpu_chrn;
+    program plain = get_variant(std::string());
+    program pgo = plain;
+    std::filesystem::path prof_dir;
+    std::error_code err_code;
+    hasher hshr;
+    int result;
     
-    output_name = spd::sys::fsys::get_tmp_path();
-    output_name += "/runsource-";
-    output_name += std::to_string(spd::sys::proc::get_pid());
-    build_result = gcc_build_c(output_name, false);
+    if (lang_ != language::C && lang_ != language::CPP)
+    {
+        std::cerr << "runsource: --pgo requires C or C++ sources" << spd::ios::newl;
+        return -1;
+    }
     
-    if (build_result == 0)
+    hshr.update(plain.get_build_key(get_compiler_name()));
+    hshr.update(train_args_.empty() ? prog_args_ : train_args_);
+    prof_dir = get_cache_path() / "profiles" / hshr.get_hex_digest();
+    
+    if (!std::filesystem::exists(prof_dir / "complete", err_code))
     {
-        command += "\"";
-        command += output_name;
-        command += "\"";
-        command += ' ';
-        
-        if (!prog_args_.empty())
-        {
-            command += prog_args_;
-            command += ' ';
-        }
-        
-        monotonic_chrn.start();
-        cpu_chrn.start();
-        spd::sys::proc::execute_command(command.c_str(), &exec_result);
-        cpu_chrn.stop();
-        monotonic_chrn.stop();
-        remove(output_name.c_str());
-        
-        if (monotonic_chrn_)
-        {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << monotonic_chrn
-                      << " seconds with return value " << exec_result;
-        }
-        else
-        {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << cpu_chrn
-                      << " CPU seconds with return value " << exec_result;
-        }
-        
-        strstream_str = strstream.str();
-        
-        std::cout << spd::ios::newl;
-        for (std::size_t i = 0; i < strstream_str.size(); i++)
+        result = plain.train_profile(prof_dir);
+        if (result != 0)
         {
-            std::cout << "-";
+            std::filesystem::remove_all(prof_dir, err_code);
+            return result;
         }
-        std::cout << spd::ios::newl
-                  << strstream_str
-                  << spd::ios::newl;
-        
-        return exec_result;
+    }
+    
+    pgo.pgo_obj_dir_ = (prof_dir / "objs").string();
+    
+    if (tool_chn_ == tool_chain::CLANG)
+    {
+        pgo.pgo_flgs_ = {"-fprofile-use=" + (prof_dir / "default.profdata").string()};
     }
     else
     {
-        return build_result;
+        pgo.pgo_flgs_ = {"-fprofile-use", "-fprofile-correction", "-Wno-missing-profile"};
     }
+    
+    return compare_variants({plain, pgo}, {"plain", "pgo"});
 }
 
 
-int program::gcc_build_cpp(const std::string& out_nme, bool verb) const
+int program::execute_watch() const
 {
-    int result = -1;
-    std::string command = "g++ ";
-    std::unordered_set<std::string> libs_to_link;
-    spd::tm::monotonic_chrono monotonic_chrn;
+    static const int sigs[] = {SIGINT, SIGTERM, SIGHUP};
     
-    for (auto& x : fles_)
-    {
-        add_c_libs_to_link_from_file(x, libs_to_link);
-        
-        command += "\"";
-        command += x.string();
-        command += "\"";
-        command += ' ';
-    }
+    watcher wtchr;
+    program prog = *this;
+    std::atomic<bool> done;
+    std::thread thrd;
+    struct sigaction sig_actn = {};
+    struct sigaction prev_actns[3];
+    bool changed;
+    int result = 0;
     
-    command += "-o ";
-    command += "\"";
-    command += out_nme.empty() ? fles_.front().stem().string() : out_nme;
-    command += "\"";
-    command += ' ';
+    prog.watch_ = false;
+    enable_cancellation();
     
-    if (!comp_args_.empty())
+    if (!wtchr.is_valid())
     {
-        command += comp_args_;
-        command += ' ';
+        std::cerr << "runsource: cannot watch the files" << spd::ios::newl;
+        return -1;
     }
     
-    for (auto& x : libs_to_link)
+    watch_stop_sig = 0;
+    sig_actn.sa_handler = stop_watching;
+    ::sigemptyset(&sig_actn.sa_mask);
+    
+    for (std::size_t i = 0; i < 3; i++)
     {
-        command += x;
-        command += ' ';
+        ::sigaction(sigs[i], &sig_actn, &prev_actns[i]);
     }
     
-    if (cpp_std_ != cpp_standard::NIL)
+    while (watch_stop_sig == 0)
     {
-        if (cpp_std_ == cpp_standard::CPP98)
+        done = false;
+        changed = false;
+        
+        if (!wtchr.watch(get_watched_files()))
+        {
+            result = -1;
+            break;
+        }
+        
+        thrd = std::thread([&]() {
+            prog.execute();
+            done = true;
+        });
+        
+        while (!done && !changed && watch_stop_sig == 0)
         {
-            command += "-std=c++98 ";
+            changed = wtchr.wait_for_change(50);
         }
-        else if (cpp_std_ == cpp_standard::CPP03)
+        
+        if (changed || watch_stop_sig != 0)
         {
-            command += "-std=c++03 ";
+            cancel_processes();
         }
-        else if (cpp_std_ == cpp_standard::CPP11)
+        
+        thrd.join();
+        resume_processes();
+        
+        if (!changed && watch_stop_sig == 0)
         {
-            command += "-std=c++11 ";
+            std::cout << spd::ios::newl << "Watching " << wtchr.get_n_files()
+                      << " files for changes..." << spd::ios::newl;
+            std::cout.flush();
+            
+            while (!wtchr.wait_for_change(-1) && wtchr.is_valid() && watch_stop_sig == 0)
+            {
+            }
         }
-        else if (cpp_std_ == cpp_standard::CPP14)
+        
+        if (!wtchr.is_valid())
         {
-            command += "-std=c++14 ";
+            result = -1;
+            break;
         }
-        else if (cpp_std_ == cpp_standard::CPP17)
+        
+        while (watch_stop_sig == 0 && wtchr.wait_for_change(100))
         {
-            command += "-std=c++17 ";
         }
-        else if (cpp_std_ == cpp_standard::CPP20)
+        
+        if (watch_stop_sig == 0)
         {
-            command += "-std=c++20 ";
+            std::cout << spd::ios::newl << "Change detected, restarting" << spd::ios::newl;
+            std::cout.flush();
         }
     }
     
-    if (optmz_)
+    for (std::size_t i = 0; i < 3; i++)
     {
-        command += "-O3 ";
+        ::sigaction(sigs[i], &prev_actns[i], nullptr);
     }
     
-    monotonic_chrn.start();
-    spd::sys::proc::execute_command(command.c_str(), &result);
-    monotonic_chrn.stop();
-    
-    if (verb && result == 0)
+    if (result != 0)
     {
-        std::cout << "C++ program build in "
-                  << std::setprecision(3)
-                  << std::fixed
-                  << monotonic_chrn
-                  << " seconds"
-                  << spd::ios::newl;
+        std::cerr << "runsource: cannot watch the files" << spd::ios::newl;
+    }
+    else if (watch_stop_sig != 0)
+    {
+        std::raise(watch_stop_sig);
     }
     
     return result;
 }
 
 
-int program::gcc_execute_cpp() const
+std::vector<std::filesystem::path> program::get_watched_files() const
 {
-    std::string output_name;
-    std::string command;
-    int build_result;
-    int exec_result = -1;
-    std::stringstream strstream;
-    std::string strstream_str;
-    spd::tm::monotonic_chrono monotonic_chrn;
-    spd::tm::child_cpu_chrono cpu_chrn;
+    std::vector<std::filesystem::path> fles = fles_;
+    std::vector<std::filesystem::path> inc_dirs = get_include_directories();
+    std::set<std::filesystem::path> hdrs;
     
-    output_name = spd::sys::fsys::get_tmp_path();
-    output_name += "/runsource-";
-    output_name += std::to_string(spd::sys::proc::get_pid());
-    build_result = gcc_build_cpp(output_name, false);
-    
-    if (build_result == 0)
+    for (auto& x : fles_)
     {
-        command += "\"";
-        command += output_name;
-        command += "\"";
-        command += ' ';
-        
-        command += prog_args_;
-        command += ' ';
+        add_local_headers_from_file(x, inc_dirs, hdrs);
+    }
     
-        monotonic_chrn.start();
-        cpu_chrn.start();
-        spd::sys::proc::execute_command(command.c_str(), &exec_result);
-        cpu_chrn.stop();
-        monotonic_chrn.stop();
-        remove(output_name.c_str());
+    fles.insert(fles.end(), hdrs.begin(), hdrs.end());
     
-        if (monotonic_chrn_)
-        {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << monotonic_chrn
-                      << " seconds with return value " << exec_result;
-        }
-        else
-        {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << cpu_chrn
-                      << " CPU seconds with return value " << exec_result;
-        }
-        
-        strstream_str = strstream.str();
-        
-        std::cout << spd::ios::newl;
-        for (std::size_t i = 0; i < strstream_str.size(); i++)
-        {
-            std::cout << "-";
-        }
-        std::cout << spd::ios::newl
-                  << strstream_str
-                  << spd::ios::newl;
-        
-        return exec_result;
-    }
-    else
-    {
-        return build_result;
-    }
+    return fles;
 }
 
 
-int program::execute_bash() const
+int program::train_profile(const std::filesystem::path& prof_dir) const
 {
-    std::string command = "bash ";
-    int exec_result;
-    std::stringstream strstream;
-    std::string strstream_str;
-    spd::tm::monotonic_chrono monotonic_chrn;
-    spd::tm::child_cpu_chrono cpu_chrn;
+    program instr = *this;
+    std::vector<std::string> args;
+    std::vector<std::string> merge_args;
+    std::string out_nme;
+    std::filesystem::path profdata_path;
+    std::error_code err_code;
+    run_sample sample;
+    bool is_tmp;
+    int result;
     
-    for (auto& x : fles_)
+    std::filesystem::remove_all(prof_dir, err_code);
+    std::filesystem::create_directories(prof_dir, err_code);
+    
+    instr.pgo_obj_dir_ = (prof_dir / "objs").string();
+    instr.pgo_flgs_ = {tool_chn_ == tool_chain::CLANG ?
+                       "-fprofile-generate=" + prof_dir.string() : "-fprofile-generate"};
+    
+    instr.init_record();
+    result = instr.build_executable(&out_nme, &is_tmp, "-instr");
+    if (result != 0)
     {
-        command += "\"";
-        command += x.string();
-        command += "\"";
-        command += ' ';
+        return result;
     }
     
-    command += prog_args_;
-    command += ' ';
+    args = split_arguments(train_args_.empty() ? prog_args_ : train_args_);
+    args.insert(args.begin(), out_nme);
     
-    monotonic_chrn.start();
-    cpu_chrn.start();
-    exec_result = system(command.c_str());
-    cpu_chrn.stop();
-    monotonic_chrn.stop();
+    launch(args, nullptr, &sample, "/dev/null");
+    result = sample.exit_code;
     
-    if (exec_result == 0)
+    if (is_tmp)
+    {
+        remove_output_file(out_nme);
+    }
+    
+    if (result != 0)
     {
+        std::cerr << "runsource: the training run exited with " << result << spd::ios::newl;
+        return result;
+    }
     
-        if (monotonic_chrn_)
+    if (tool_chn_ == tool_chain::CLANG)
+    {
+        profdata_path = find_executable("llvm-profdata");
+        if (profdata_path.empty())
         {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << monotonic_chrn
-                      << " seconds with return value " << exec_result;
+            std::cerr << "runsource: llvm-profdata not found" << spd::ios::newl;
+            return -1;
         }
-        else
+        
+        merge_args = {profdata_path.string(), "merge", "-o",
+                      (prof_dir / "default.profdata").string()};
+        
+        for (auto& x : std::filesystem::directory_iterator(prof_dir, err_code))
         {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << cpu_chrn
-                      << " CPU seconds with return value " << exec_result;
+            if (x.path().extension() == ".profraw")
+            {
+                merge_args.push_back(x.path().string());
+            }
         }
         
-        strstream_str = strstream.str();
-        
-        std::cout << spd::ios::newl;
-        for (std::size_t i = 0; i < strstream_str.size(); i++)
+        result = run_process(merge_args, diag_path_);
+        if (result != 0)
         {
-            std::cout << "-";
+            return result;
         }
-        std::cout << spd::ios::newl
-                  << strstream_str
-                  << spd::ios::newl;
     }
     
-    return exec_result;
+    std::ofstream(prof_dir / "complete");
+    
+    std::cout << "Profile trained in " << instr.rec_.build_tme + sample.wall_tme
+              << " seconds" << spd::ios::newl;
+    
+    return 0;
 }
 
 
-int program::execute_python() const
+int program::compare_variants(
+        std::vector<program> variants,
+        const std::vector<std::string>& nmes
+) const
 {
-    std::string command = "python ";
-    int exec_result;
-    std::stringstream strstream;
-    std::string strstream_str;
-    spd::tm::monotonic_chrono monotonic_chrn;
-    spd::tm::child_cpu_chrono cpu_chrn;
+    std::vector<std::string> out_nmes;
+    std::vector<bool> outs_are_tmp;
+    std::vector<std::vector<std::string>> args;
+    std::vector<std::vector<run_sample>> samples;
+    std::vector<sample_summary> summs;
+    std::error_code err_code;
+    run_sample sample;
+    isolation isoltn = isoltn_;
+    bool is_tmp;
+    int result = 0;
+    auto get_tme = [&](const run_sample& sample) {
+        return monotonic_chrn_ ? sample.wall_tme : sample.cpu_tme;
+    };
     
-    for (auto& x : fles_)
+    out_nmes.resize(variants.size());
+    outs_are_tmp.resize(variants.size(), false);
+    args.resize(variants.size());
+    samples.resize(variants.size());
+    
+    for (std::size_t i = 0; i < variants.size() && result == 0; i++)
     {
-        command += "\"";
-        command += x.string();
-        command += "\"";
-        command += ' ';
+        variants[i].init_record();
+        result = variants[i].build_executable(&out_nmes[i], &is_tmp, "-" + std::to_string(i));
+        outs_are_tmp[i] = is_tmp;
     }
     
-    command += prog_args_;
-    command += ' ';
-    
-    monotonic_chrn.start();
-    cpu_chrn.start();
-    exec_result = system(command.c_str());
-    cpu_chrn.stop();
-    monotonic_chrn.stop();
-    
-    if (exec_result == 0)
+    if (result == 0 && !isoltn.enter())
     {
+        result = -1;
+    }
     
-        if (monotonic_chrn_)
+    if (result == 0)
+    {
+        for (std::size_t i = 0; i < variants.size(); i++)
+        {
+            args[i] = split_arguments(prog_args_);
+            args[i].insert(args[i].begin(), out_nmes[i]);
+        }
+        
+        for (std::size_t i = 0; i < warmup_; i++)
+        {
+            for (auto& x : args)
+            {
+                launch(x, nullptr, &sample, std::string(), std::string(), &isoltn);
+            }
+        }
+        
+        for (std::size_t i = 0; i < std::max<std::size_t>(repeat_, 1); i++)
+        {
+            for (std::size_t j = 0; j < variants.size(); j++)
+            {
+                launch(args[j], nullptr, &sample, std::string(), std::string(), &isoltn);
+                samples[j].push_back(sample);
+                result = result == 0 ? sample.exit_code : result;
+            }
+        }
+        
+        isoltn.leave();
+        
+        for (auto& x : samples)
+        {
+            std::vector<double> tmes;
+            
+            for (auto& y : x)
+            {
+                tmes.push_back(get_tme(y));
+            }
+            
+            summs.push_back(summarize(tmes));
+        }
+        
+        std::cout << spd::ios::newl
+                  << std::left << std::setw(32) << "Variant" << std::right
+                  << std::setw(12) << "build (s)"
+                  << std::setw(12) << "size (KiB)"
+                  << std::setw(12) << "median (s)"
+                  << std::setw(12) << "mean (s)"
+                  << std::setw(12) << "stddev (s)"
+                  << std::setw(10) << "speedup"
+                  << spd::ios::newl;
+        
+        for (std::size_t i = 0; i < variants.size(); i++)
+        {
+            std::cout << std::left << std::setw(32)
+                      << (i == 0 ? nmes[i] + " (baseline)" : nmes[i])
+                      << std::right << std::setprecision(3) << std::fixed
+                      << std::setw(12) << variants[i].rec_.build_tme
+                      << std::setprecision(1)
+                      << std::setw(12) << std::filesystem::file_size(out_nmes[i], err_code) / 1024.0
+                      << std::setprecision(6)
+                      << std::setw(12) << summs[i].median
+                      << std::setw(12) << summs[i].mean
+                      << std::setw(12) << summs[i].stddev
+                      << std::setprecision(2)
+                      << std::setw(9)
+                      << (summs[i].median > 0 ? summs[0].median / summs[i].median : 0)
+                      << 'x' << spd::ios::newl;
+        }
+        
+        std::cout << "Times are " << (monotonic_chrn_ ? "wall" : "CPU") << " seconds over "
+                  << samples.front().size() << " interleaved runs per variant." << spd::ios::newl;
+        
+        if (!frmt_.empty())
+        {
+            for (std::size_t i = 0; i < variants.size(); i++)
+            {
+                variants[i].rec_.warmup = warmup_;
+                variants[i].rec_.samples = samples[i];
+                variants[i].write_record();
+            }
+        }
+    }
+    
+    for (std::size_t i = 0; i < variants.size(); i++)
+    {
+        if (outs_are_tmp[i])
+        {
+            remove_output_file(out_nmes[i]);
+        }
+    }
+    
+    return result;
+}
+
+
+std::vector<program> program::get_batch_programs() const
+{
+    std::vector<program> progs;
+    std::vector<std::filesystem::path> fles;
+    std::string ext;
+    std::error_code err_code;
+    
+    for (auto& x : fles_)
+    {
+        if (!std::filesystem::is_directory(x, err_code))
+        {
+            fles.push_back(x);
+            continue;
+        }
+        
+        std::vector<std::filesystem::path> dir_fles;
+        
+        for (auto it = std::filesystem::recursive_directory_iterator(x, err_code);
+             it != std::filesystem::recursive_directory_iterator();
+             it.increment(err_code))
+        {
+            ext = it->path().extension().string();
+            
+            if (it->is_regular_file(err_code) &&
+                (c_exts_.count(ext) != 0 || cpp_exts_.count(ext) != 0 ||
+                 bash_exts_.count(ext) != 0 || python_exts_.count(ext) != 0))
+            {
+                dir_fles.push_back(it->path());
+            }
+        }
+        
+        std::sort(dir_fles.begin(), dir_fles.end());
+        fles.insert(fles.end(), dir_fles.begin(), dir_fles.end());
+    }
+    
+    for (auto& x : fles)
+    {
+        program prog = *this;
+        
+        prog.batch_ = false;
+        prog.jobs_ = 1;
+        prog.fles_ = {x};
+        prog.lang_ = prog.is_c() ? language::C :
+                     prog.is_cpp() ? language::CPP :
+                     prog.is_python() ? language::PYTHON :
+                     prog.is_bash() ? language::BASH :
+                     language::NIL;
+        
+        if (prog.lang_ == language::NIL)
+        {
+            continue;
+        }
+        
+        if (lang_ != language::NIL)
+        {
+            prog.lang_ = lang_;
+        }
+        
+        progs.push_back(std::move(prog));
+    }
+    
+    return progs;
+}
+
+
+program program::get_variant(const std::string& variant) const
+{
+    static const std::map<std::string, c_standard> c_stds = {
+            {"--c89", c_standard::C89},
+            {"--c90", c_standard::C90},
+            {"--c99", c_standard::C99},
+            {"--c11", c_standard::C11},
+    };
+    
+    static const std::map<std::string, cpp_standard> cpp_stds = {
+            {"--c++98", cpp_standard::CPP98},
+            {"--c++03", cpp_standard::CPP03},
+            {"--c++11", cpp_standard::CPP11},
+            {"--c++14", cpp_standard::CPP14},
+            {"--c++17", cpp_standard::CPP17},
+            {"--c++20", cpp_standard::CPP20},
+    };
+    
+    program prog = *this;
+    
+    prog.matrix_.clear();
+    prog.cmp_tool_chns_ = false;
+    
+    for (auto& x : split_arguments(variant))
+    {
+        if (c_stds.count(x) != 0)
+        {
+            prog.c_std_ = c_stds.at(x);
+        }
+        else if (cpp_stds.count(x) != 0)
+        {
+            prog.cpp_std_ = cpp_stds.at(x);
+        }
+        else if (x == "--optimize")
+        {
+            prog.optmz_ = true;
+        }
+        else if (x == "--unity")
+        {
+            prog.unity_ = true;
+        }
+        else if (x == "--lto")
+        {
+            prog.lto_ = true;
+        }
+        else
+        {
+            prog.comp_args_ += prog.comp_args_.empty() ? "" : " ";
+            prog.comp_args_ += join_arguments({x});
+        }
+    }
+    
+    return prog;
+}
+
+
+void program::init_record() const
+{
+    hasher hshr;
+    
+    rec_ = run_record();
+    rec_.lang = lang_ == language::C ? "c" :
+                lang_ == language::CPP ? "c++" :
+                lang_ == language::BASH ? "bash" :
+                lang_ == language::PYTHON ? "python" :
+                "";
+    rec_.optmz = optmz_;
+    rec_.flgs = split_arguments(comp_args_);
+    fill_host_info(&rec_);
+    
+    if (lang_ == language::C || lang_ == language::CPP)
+    {
+        rec_.tool_chn = get_tool_chain_name();
+        rec_.standard = lang_ == language::C ? get_c_standard_flag() : get_cpp_standard_flag();
+        rec_.standard.erase(0, 5);
+    }
+    
+    for (auto& x : fles_)
+    {
+        hshr = hasher();
+        hshr.update_from_file(x);
+        rec_.fle_hashes.emplace_back(x.string(), hshr.get_hex_digest());
+    }
+}
+
+
+bool program::is_c() const noexcept
+{
+    for (auto& x : fles_)
+    {
+        if (c_exts_.count(x.extension()) == 0)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+bool program::is_cpp() const noexcept
+{
+    for (auto& x : fles_)
+    {
+        if (cpp_exts_.count(x.extension()) == 0)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+bool program::is_bash() const noexcept
+{
+    for (auto& x : fles_)
+    {
+        if (bash_exts_.count(x.extension()) == 0 && x.has_extension())
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+bool program::is_python() const noexcept
+{
+    for (auto& x : fles_)
+    {
+        if (python_exts_.count(x.extension()) == 0)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+int program::build_c(
+        const std::string& out_nme,
+        bool verb,
+        std::vector<std::filesystem::path>* deps
+) const
+{
+    int result;
+    double pch_saved_tme = 0;
+    spd::tm::monotonic_chrono monotonic_chrn;
+    
+    monotonic_chrn.start();
+    result = build_sources(get_compiler_name(), get_c_standard_flag(),
+                           out_nme.empty() ? fles_.front().stem().string() : out_nme,
+                           &pch_saved_tme, deps);
+    monotonic_chrn.stop();
+    
+    if (verb && result == 0)
+    {
+        std::cout << "C program build in "
+                  << std::setprecision(3)
+                  << std::fixed
+                  << monotonic_chrn
+                  << " seconds (link "
+                  << rec_.link_tme
+                  << " seconds with "
+                  << rec_.linker
+                  << " linker)";
+        
+        if (pch_saved_tme > 0)
+        {
+            std::cout << " (precompiled headers saved about "
+                      << pch_saved_tme
+                      << " seconds)";
+        }
+        
+        std::cout << spd::ios::newl;
+    }
+    
+    return result;
+}
+
+
+int program::execute_c() const
+{
+    std::string output_name;
+    std::vector<std::string> args;
+    bool output_is_tmp;
+    int build_result;
+    int exec_result;
+    
+    build_result = build_executable(&output_name, &output_is_tmp);
+    
+    if (build_result == 0)
+    {
+        args = split_arguments(prog_args_);
+        args.insert(args.begin(), output_name);
+        
+        exec_result = run_command(args);
+        
+        if (output_is_tmp)
+        {
+            remove_output_file(output_name);
+        }
+        
+        return exec_result;
+    }
+    else
+    {
+        return build_result;
+    }
+}
+
+
+int program::build_cpp(
+        const std::string& out_nme,
+        bool verb,
+        std::vector<std::filesystem::path>* deps
+) const
+{
+    int result;
+    double pch_saved_tme = 0;
+    spd::tm::monotonic_chrono monotonic_chrn;
+    
+    monotonic_chrn.start();
+    result = build_sources(get_compiler_name(), get_cpp_standard_flag(),
+                           out_nme.empty() ? fles_.front().stem().string() : out_nme,
+                           &pch_saved_tme, deps);
+    monotonic_chrn.stop();
+    
+    if (verb && result == 0)
+    {
+        std::cout << "C++ program build in "
+                  << std::setprecision(3)
+                  << std::fixed
+                  << monotonic_chrn
+                  << " seconds (link "
+                  << rec_.link_tme
+                  << " seconds with "
+                  << rec_.linker
+                  << " linker)";
+        
+        if (pch_saved_tme > 0)
+        {
+            std::cout << " (precompiled headers saved about "
+                      << pch_saved_tme
+                      << " seconds)";
+        }
+        
+        std::cout << spd::ios::newl;
+    }
+    
+    return result;
+}
+
+
+int program::execute_cpp() const
+{
+    std::string output_name;
+    std::vector<std::string> args;
+    bool output_is_tmp;
+    int build_result;
+    int exec_result;
+    
+    build_result = build_executable(&output_name, &output_is_tmp);
+    
+    if (build_result == 0)
+    {
+        args = split_arguments(prog_args_);
+        args.insert(args.begin(), output_name);
+        
+        exec_result = run_command(args);
+        
+        if (output_is_tmp)
+        {
+            remove_output_file(output_name);
+        }
+        
+        return exec_result;
+    }
+    else
+    {
+        return build_result;
+    }
+}
+
+
+int program::build_sources(
+        const std::string& comp_nme,
+        const std::string& std_flg,
+        const std::string& out_nme,
+        double* pch_saved_tme,
+        std::vector<std::filesystem::path>* deps
+) const
+{
+    int result = -1;
+    std::vector<std::string> flgs = split_arguments(comp_args_);
+    std::vector<std::string> args = {comp_nme};
+    std::vector<std::filesystem::path> srcs = fles_;
+    std::string obj_dir;
+    std::vector<std::string> objs;
+    std::vector<std::vector<std::string>> pch_flgs(fles_.size());
+    std::vector<std::vector<std::filesystem::path>> obj_deps;
+    std::set<std::filesystem::path> all_deps;
+    std::unordered_set<std::string> libs_to_link;
+    std::chrono::steady_clock::time_point start_tme = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point link_start_tme;
+    double link_tme;
+    std::unique_ptr<build_profile> prof;
+    std::string linker = get_linker();
+    std::string link_out = out_nme;
+    std::error_code err_code;
+    job_pool pool(jobs_);
+    
+    if (build_prof_)
+    {
+        prof = std::make_unique<build_profile>();
+    }
+    
+    for (auto& x : scan_directives(fles_, jobs_))
+    {
+        for (auto& y : x)
+        {
+            if (y.typ == directive_type::LINK_LIB)
+            {
+                libs_to_link.insert(y.val);
+            }
+        }
+    }
+    
+    if (!std_flg.empty())
+    {
+        flgs.push_back(std_flg);
+    }
+    
+    if (!get_include_path().empty() && uses_bench_header())
+    {
+        flgs.push_back("-isystem");
+        flgs.push_back(get_include_path().string());
+    }
+    
+    if (optmz_)
+    {
+        flgs.push_back("-O3");
+    }
+    
+    flgs.insert(flgs.end(), pgo_flgs_.begin(), pgo_flgs_.end());
+    
+    if (lto_)
+    {
+        flgs.push_back(tool_chn_ == tool_chain::CLANG ? "-flto=thin" :
+                       jobs_ == 0 ? "-flto=auto" : "-flto=" + std::to_string(jobs_));
+    }
+    
+    if (lang_ == language::CPP && tool_chn_ == tool_chain::CLANG && !stdlib_.empty())
+    {
+        flgs.push_back("-stdlib=" + stdlib_);
+    }
+    
+    if (unity_ && fles_.size() > 1)
+    {
+        srcs = {get_unity_source()};
+        if (srcs.front().empty())
+        {
+            return -1;
+        }
+    }
+    else if (pch_ && cache_)
+    {
+        prepare_precompiled_headers(comp_nme, flgs, &pch_flgs, pch_saved_tme);
+    }
+    
+    obj_dir = out_nme + "-objs";
+    objs.resize(srcs.size());
+    obj_deps.resize(srcs.size());
+    
+    if (!pgo_obj_dir_.empty())
+    {
+        obj_dir = pgo_obj_dir_;
+    }
+    else if (is_memory_file(out_nme))
+    {
+        obj_dir = get_tmpfs_path().string();
+        obj_dir += "/runsource-";
+        obj_dir += std::to_string(spd::sys::proc::get_pid());
+        obj_dir += "-" + std::filesystem::path(out_nme).filename().string() + "-objs";
+    }
+    
+    if (is_memory_file(out_nme) && (linker == "lld" || linker == "mold"))
+    {
+        link_out = get_tmpfs_path().string();
+        link_out += "/runsource-";
+        link_out += std::to_string(spd::sys::proc::get_pid());
+        link_out += "-" + std::filesystem::path(out_nme).filename().string();
+    }
+    
+    for (std::size_t i = 0; i < srcs.size(); i++)
+    {
+        pool.push([&, i]() {
+            std::vector<std::string> obj_flgs = flgs;
+            
+            obj_flgs.insert(obj_flgs.end(), pch_flgs[i].begin(), pch_flgs[i].end());
+            
+            return compile_object(
+                    comp_nme,
+                    obj_flgs,
+                    srcs[i],
+                    obj_dir + "/" + std::to_string(i) + "-" + srcs[i].stem().string() + ".o",
+                    &objs[i],
+                    deps == nullptr ? nullptr : &obj_deps[i],
+                    prof.get());
+        });
+    }
+    
+    result = pool.run();
+    
+    if (result != 0)
+    {
+        if (pgo_obj_dir_.empty())
+        {
+            std::filesystem::remove_all(obj_dir);
+        }
+        
+        return result;
+    }
+    
+    args.insert(args.end(), objs.begin(), objs.end());
+    
+    args.push_back("-o");
+    args.push_back(link_out);
+    args.insert(args.end(), flgs.begin(), flgs.end());
+    
+    if (!linker.empty())
+    {
+        args.push_back("-fuse-ld=" + linker);
+    }
+    
+    for (auto& x : libs_to_link)
+    {
+        args.push_back(x);
+    }
+    
+    link_start_tme = std::chrono::steady_clock::now();
+    result = run_process(args, diag_path_);
+    link_tme = std::chrono::duration<double>(std::chrono::steady_clock::now() - link_start_tme)
+            .count();
+    rec_.linker = linker.empty() ? "default" : linker;
+    rec_.link_tme += link_tme;
+    
+    if (link_out != out_nme)
+    {
+        if (result == 0 && !copy_to_memory_file(link_out, out_nme))
+        {
+            std::cerr << "runsource: cannot copy " << link_out << " into memory" << spd::ios::newl;
+            result = -1;
+        }
+        
+        std::filesystem::remove(link_out, err_code);
+    }
+    
+    if (pgo_obj_dir_.empty())
+    {
+        std::filesystem::remove_all(obj_dir);
+    }
+    
+    if (cache_ && deps == nullptr)
+    {
+        build_cache(get_cache_path(), cache_max_sze_).trim();
+    }
+    
+    if (deps != nullptr)
+    {
+        for (auto& x : obj_deps)
+        {
+            all_deps.insert(x.begin(), x.end());
+        }
+        
+        deps->assign(all_deps.begin(), all_deps.end());
+    }
+    
+    if (prof && result == 0)
+    {
+        prof->add_link_time(link_tme);
+        
+        if (!prof->has_header_costs())
+        {
+            measure_header_costs(comp_nme, flgs, prof.get());
+        }
+        
+        prof->print(std::cout);
+    }
+    
+    rec_.build_command = join_arguments(args);
+    rec_.build_tme += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme)
+            .count();
+    
+    return result;
+}
+
+
+int program::compile_object(
+        const std::string& comp_nme,
+        const std::vector<std::string>& flgs,
+        const std::filesystem::path& src_path,
+        const std::string& tmp_obj_path,
+        std::string* obj_path,
+        std::vector<std::filesystem::path>* deps,
+        build_profile* prof
+) const
+{
+    int result;
+    std::vector<std::string> args = {comp_nme, "-c", src_path.string()};
+    std::string report_path;
+    std::string tmp_depfle;
+    std::string ky;
+    std::vector<std::filesystem::path> obj_deps;
+    std::filesystem::path entry_path;
+    std::filesystem::path stagng_path;
+    std::ofstream diag_ofs;
+    build_cache cache(get_cache_path(), cache_max_sze_);
+    hasher hshr;
+    auto compile = [&](const std::string& obj, const std::string& depfle) {
+        std::vector<std::string> obj_args = args;
+        
+        obj_args.push_back("-o");
+        obj_args.push_back(obj);
+        
+        if (!depfle.empty())
+        {
+            obj_args.push_back("-MD");
+            obj_args.push_back("-MF");
+            obj_args.push_back(depfle);
+        }
+        
+        return run_process(obj_args, diag_path_);
+    };
+    auto compile_tmp = [&]() {
+        std::filesystem::create_directories(std::filesystem::path(tmp_obj_path).parent_path());
+        *obj_path = tmp_obj_path;
+        
+        if (deps == nullptr)
+        {
+            return compile(tmp_obj_path, std::string());
+        }
+        
+        tmp_depfle = std::filesystem::path(tmp_obj_path).replace_extension(".d").string();
+        result = compile(tmp_obj_path, tmp_depfle);
+        
+        if (result == 0)
+        {
+            *deps = parse_depfile(tmp_depfle);
+        }
+        
+        return result;
+    };
+    
+    args.insert(args.end(), flgs.begin(), flgs.end());
+    
+    if (prof != nullptr)
+    {
+        std::filesystem::create_directories(std::filesystem::path(tmp_obj_path).parent_path());
+        *obj_path = tmp_obj_path;
+        report_path = std::filesystem::path(tmp_obj_path).replace_extension(".json").string();
+        
+        if (tool_chn_ == tool_chain::CLANG)
+        {
+            args.push_back("-ftime-trace");
+            result = compile(tmp_obj_path, std::string());
+            prof->add_time_trace(report_path);
+        }
+        else
+        {
+            args.insert(args.end(), {"-ftime-report", "-o", tmp_obj_path});
+            result = run_process(args, report_path);
+            
+            if (!diag_path_.empty())
+            {
+                diag_ofs.open(diag_path_, std::ios::app);
+            }
+            
+            prof->add_time_report(report_path, diag_path_.empty() ? std::cerr : diag_ofs);
+        }
+        
+        return result;
+    }
+    
+    if (!cache_ || !pgo_obj_dir_.empty())
+    {
+        return compile_tmp();
+    }
+    
+    hshr.update(get_executable_id(comp_nme));
+    
+    for (auto& x : args)
+    {
+        hshr.update(x);
+    }
+    
+    ky = hshr.get_hex_digest();
+    
+    if (cache.find_up_to_date(ky, &entry_path) &&
+        (deps == nullptr || build_cache::read_manifest(entry_path, deps)))
+    {
+        *obj_path = (entry_path / "object.o").string();
+        return 0;
+    }
+    
+    stagng_path = cache.create_staging_directory(ky);
+    if (stagng_path.empty())
+    {
+        return compile_tmp();
+    }
+    
+    result = compile((stagng_path / "object.o").string(), (stagng_path / "object.d").string());
+    
+    if (result != 0)
+    {
+        cache.discard(stagng_path);
+        return result;
+    }
+    
+    obj_deps = parse_depfile(stagng_path / "object.d");
+    
+    if (!build_cache::write_manifest(stagng_path, obj_deps) ||
+        !cache.commit(ky, stagng_path, &entry_path))
+    {
+        cache.discard(stagng_path);
+        return compile_tmp();
+    }
+    
+    *obj_path = (entry_path / "object.o").string();
+    
+    if (deps != nullptr)
+    {
+        *deps = std::move(obj_deps);
+    }
+    
+    return 0;
+}
+
+
+void program::measure_header_costs(
+        const std::string& comp_nme,
+        const std::vector<std::string>& flgs,
+        build_profile* prof
+) const
+{
+    std::set<std::string> incs;
+    std::vector<std::string> args;
+    std::string src_path = spd::sys::fsys::get_tmp_path();
+    std::chrono::steady_clock::time_point start_tme;
+    double base_tme = 0;
+    double tme;
+    std::ofstream ofs;
+    std::error_code err_code;
+    
+    src_path += "/runsource-";
+    src_path += std::to_string(spd::sys::proc::get_pid());
+    src_path += lang_ == language::C ? "-header.c" : "-header.cpp";
+    
+    for (auto& x : fles_)
+    {
+        for (auto& y : scan_directives(x))
+        {
+            if (y.typ == directive_type::INCLUDE)
+            {
+                incs.insert(y.val);
+            }
+        }
+    }
+    
+    incs.insert(std::string());
+    
+    for (auto& x : incs)
+    {
+        ofs.open(src_path, std::ios::trunc);
+        
+        if (!x.empty())
+        {
+            ofs << "#include " << x << '\n';
+        }
+        
+        ofs.close();
+        
+        args = {comp_nme, "-fsyntax-only", src_path};
+        args.insert(args.end(), flgs.begin(), flgs.end());
+        
+        for (auto& y : fles_)
+        {
+            args.push_back("-iquote");
+            args.push_back(y.parent_path().string());
+        }
+        
+        start_tme = std::chrono::steady_clock::now();
+        if (run_process(args, "/dev/null") != 0)
+        {
+            continue;
+        }
+        
+        tme = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme).count();
+        
+        if (x.empty())
+        {
+            base_tme = tme;
+        }
+        else
+        {
+            prof->add_header_cost(x, std::max(tme - base_tme, 0.0));
+        }
+    }
+    
+    std::filesystem::remove(src_path, err_code);
+}
+
+
+void program::prepare_precompiled_headers(
+        const std::string& comp_nme,
+        const std::vector<std::string>& flgs,
+        std::vector<std::vector<std::string>>* pch_flgs,
+        double* pch_saved_tme
+) const
+{
+    std::map<std::string, std::vector<std::size_t>> fles_by_incs;
+    std::vector<std::string> hdr_contents;
+    std::vector<std::vector<std::string>> hdr_flgs;
+    std::vector<double> saved_tmes;
+    std::string hdr_content;
+    job_pool pool(jobs_);
+    
+    for (std::size_t i = 0; i < fles_.size(); i++)
+    {
+        hdr_content.clear();
+        
+        for (auto& x : get_leading_system_includes(fles_[i]))
+        {
+            hdr_content += x;
+            hdr_content += '\n';
+        }
+        
+        if (!hdr_content.empty())
+        {
+            fles_by_incs[hdr_content].push_back(i);
+        }
+    }
+    
+    for (auto& x : fles_by_incs)
+    {
+        hdr_contents.push_back(x.first);
+    }
+    
+    hdr_flgs.resize(hdr_contents.size());
+    saved_tmes.resize(hdr_contents.size(), 0);
+    
+    for (std::size_t i = 0; i < hdr_contents.size(); i++)
+    {
+        pool.push([&, i]() {
+            build_precompiled_header(comp_nme, flgs, hdr_contents[i], &hdr_flgs[i],
+                                     &saved_tmes[i]);
+            return 0;
+        });
+    }
+    
+    pool.run();
+    
+    for (std::size_t i = 0; i < hdr_contents.size(); i++)
+    {
+        for (auto& x : fles_by_incs[hdr_contents[i]])
+        {
+            (*pch_flgs)[x] = hdr_flgs[i];
+            
+            if (pch_saved_tme != nullptr)
+            {
+                *pch_saved_tme += saved_tmes[i];
+            }
+        }
+    }
+}
+
+
+bool program::build_precompiled_header(
+        const std::string& comp_nme,
+        const std::vector<std::string>& flgs,
+        const std::string& hdr_content,
+        std::vector<std::string>* pch_flgs,
+        double* saved_tme
+) const
+{
+    std::vector<std::string> args;
+    std::string ky;
+    std::filesystem::path entry_path;
+    std::filesystem::path stagng_path;
+    std::filesystem::path hdr_path;
+    std::vector<std::filesystem::path> deps;
+    std::chrono::steady_clock::time_point start_tme;
+    double parse_tme;
+    double load_tme;
+    build_cache cache(get_cache_path(), cache_max_sze_);
+    hasher hshr;
+    std::ifstream ifs;
+    std::ofstream ofs;
+    
+    hshr.update(std::string("pch"));
+    hshr.update(get_executable_id(comp_nme));
+    
+    for (auto& x : flgs)
+    {
+        hshr.update(x);
+    }
+    
+    hshr.update(hdr_content);
+    ky = hshr.get_hex_digest();
+    
+    if (cache.find_up_to_date(ky, &entry_path))
+    {
+        ifs.open(entry_path / "saved_time");
+        if (ifs >> parse_tme)
+        {
+            *saved_tme = parse_tme;
+        }
+        
+        *pch_flgs = {"-include", (entry_path / "pch.h").string(), "-Winvalid-pch"};
+        
+        return true;
+    }
+    
+    stagng_path = cache.create_staging_directory(ky);
+    if (stagng_path.empty())
+    {
+        return false;
+    }
+    
+    hdr_path = stagng_path / "pch.h";
+    ofs.open(hdr_path);
+    ofs << hdr_content;
+    ofs.close();
+    
+    args = {comp_nme, "-x", lang_ == language::C ? "c-header" : "c++-header", hdr_path.string(),
+            "-o", hdr_path.string() + (tool_chn_ == tool_chain::CLANG ? ".pch" : ".gch")};
+    args.insert(args.end(), flgs.begin(), flgs.end());
+    args.insert(args.end(), {"-MD", "-MF", (stagng_path / "pch.d").string()});
+    
+    if (run_process(args, diag_path_) != 0)
+    {
+        cache.discard(stagng_path);
+        return false;
+    }
+    
+    args = {comp_nme, "-fsyntax-only", "-x", lang_ == language::C ? "c" : "c++", hdr_path.string()};
+    args.insert(args.end(), flgs.begin(), flgs.end());
+    
+    start_tme = std::chrono::steady_clock::now();
+    run_process(args);
+    parse_tme = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme).count();
+    
+    args = {comp_nme, "-fsyntax-only", "-x", lang_ == language::C ? "c" : "c++", "/dev/null"};
+    args.insert(args.end(), flgs.begin(), flgs.end());
+    args.insert(args.end(), {"-include", hdr_path.string()});
+    
+    start_tme = std::chrono::steady_clock::now();
+    run_process(args);
+    load_tme = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_tme).count();
+    
+    for (auto& x : parse_depfile(stagng_path / "pch.d"))
+    {
+        if (x.parent_path() != stagng_path)
+        {
+            deps.push_back(x);
+        }
+    }
+    
+    ofs.open(stagng_path / "saved_time");
+    ofs << std::max(parse_tme - load_tme, 0.0) << spd::ios::newl;
+    ofs.close();
+    
+    if (!build_cache::write_manifest(stagng_path, deps) ||
+        !cache.commit(ky, stagng_path, &entry_path))
+    {
+        cache.discard(stagng_path);
+        return false;
+    }
+    
+    *pch_flgs = {"-include", (entry_path / "pch.h").string(), "-Winvalid-pch"};
+    
+    return true;
+}
+
+
+std::vector<std::string> program::get_leading_system_includes(
+        const std::filesystem::path& fle_path
+) const
+{
+    std::vector<std::string> incs;
+    std::string curr_line;
+    std::size_t pos;
+    std::size_t end_pos;
+    bool in_comment = false;
+    std::ifstream ifs(fle_path);
+    
+    while (std::getline(ifs, curr_line))
+    {
+        pos = 0;
+        
+        if (in_comment)
+        {
+            pos = curr_line.find("*/");
+            if (pos == std::string::npos)
+            {
+                continue;
+            }
+            
+            in_comment = false;
+            pos += 2;
+        }
+        
+        pos = curr_line.find_first_not_of(" \t\r", pos);
+        if (pos == std::string::npos || curr_line.compare(pos, 2, "//") == 0)
+        {
+            continue;
+        }
+        
+        if (curr_line.compare(pos, 2, "/*") == 0)
+        {
+            end_pos = curr_line.find("*/", pos + 2);
+            in_comment = end_pos == std::string::npos;
+            
+            if (in_comment || curr_line.find_first_not_of(" \t\r", end_pos + 2) ==
+                              std::string::npos)
+            {
+                continue;
+            }
+            
+            break;
+        }
+        
+        if (curr_line[pos] != '#')
+        {
+            break;
+        }
+        
+        pos = curr_line.find_first_not_of(" \t", pos + 1);
+        if (pos != std::string::npos && curr_line.compare(pos, 6, "pragma") == 0 &&
+            curr_line.find("comment", pos + 6) != std::string::npos)
+        {
+            continue;
+        }
+        
+        if (pos == std::string::npos || curr_line.compare(pos, 7, "include") != 0)
+        {
+            break;
+        }
+        
+        pos = curr_line.find_first_not_of(" \t", pos + 7);
+        end_pos = pos == std::string::npos ? pos : curr_line.find('>', pos);
+        if (end_pos == std::string::npos || curr_line[pos] != '<')
+        {
+            break;
+        }
+        
+        incs.push_back("#include " + curr_line.substr(pos, end_pos - pos + 1));
+    }
+    
+    return incs;
+}
+
+
+std::string program::get_c_standard_flag() const
+{
+    switch (c_std_)
+    {
+        case c_standard::C89:
+            return "-std=c89";
+        
+        case c_standard::C90:
+            return "-std=c90";
+        
+        case c_standard::C99:
+            return "-std=c99";
+        
+        case c_standard::C11:
+            return "-std=c11";
+        
+        default:
+            return std::string();
+    }
+}
+
+
+std::string program::get_cpp_standard_flag() const
+{
+    switch (cpp_std_)
+    {
+        case cpp_standard::CPP98:
+            return "-std=c++98";
+        
+        case cpp_standard::CPP03:
+            return "-std=c++03";
+        
+        case cpp_standard::CPP11:
+            return "-std=c++11";
+        
+        case cpp_standard::CPP14:
+            return "-std=c++14";
+        
+        case cpp_standard::CPP17:
+            return "-std=c++17";
+        
+        case cpp_standard::CPP20:
+            return "-std=c++20";
+        
+        default:
+            return std::string();
+    }
+}
+
+
+std::string program::get_compiler_name() const
+{
+    switch (tool_chn_)
+    {
+        case tool_chain::GCC:
+            return lang_ == language::C ? "gcc" : "g++";
+        
+        case tool_chain::CLANG:
+            return lang_ == language::C ? "clang" : "clang++";
+        
+        default:
+            return std::string();
+    }
+}
+
+
+std::string program::get_linker() const
+{
+    static const std::pair<const char*, const char*> linkrs[] = {
+            {"mold", "ld.mold"},
+            {"lld", "ld.lld"},
+            {"gold", "ld.gold"},
+    };
+    
+    if (!linker_.empty() && linker_ != "auto")
+    {
+        return linker_;
+    }
+    
+    for (auto& x : linkrs)
+    {
+        if (!find_executable(x.second).empty())
         {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << monotonic_chrn
-                      << " seconds with return value " << exec_result;
+            return x.first;
         }
-        else
+    }
+    
+    return std::string();
+}
+
+
+std::string program::get_tool_chain_name() const
+{
+    switch (tool_chn_)
+    {
+        case tool_chain::GCC:
+            return "gcc";
+        
+        case tool_chain::CLANG:
+            return stdlib_.empty() || lang_ != language::CPP ? "clang" : "clang/" + stdlib_;
+        
+        default:
+            return std::string();
+    }
+}
+
+
+int program::execute_bash() const
+{
+    std::vector<std::string> args = {"bash"};
+    std::vector<std::string> prog_args = split_arguments(prog_args_);
+    
+    for (auto& x : fles_)
+    {
+        args.push_back(x.string());
+    }
+    
+    args.insert(args.end(), prog_args.begin(), prog_args.end());
+    
+    return run_command(args);
+}
+
+
+int program::execute_python() const
+{
+    std::vector<std::string> args = {"python"};
+    std::vector<std::string> prog_args = split_arguments(prog_args_);
+    
+    for (auto& x : fles_)
+    {
+        args.push_back(x.string());
+    }
+    
+    args.insert(args.end(), prog_args.begin(), prog_args.end());
+    
+    return run_command(args);
+}
+
+
+bool program::uses_bench_header() const
+{
+    if (lang_ != language::CPP)
+    {
+        return false;
+    }
+    
+    for (auto& x : scan_directives(fles_, jobs_))
+    {
+        for (auto& y : x)
         {
-            strstream << "Process exited after "
-                      << std::setprecision(3)
-                      << std::fixed
-                      << cpu_chrn
-                      << " CPU seconds with return value " << exec_result;
+            if (y.typ == directive_type::INCLUDE &&
+                (y.val == "<runsource/bench.hpp>" || y.val == "\"runsource/bench.hpp\""))
+            {
+                return true;
+            }
         }
+    }
+    
+    return false;
+}
+
+
+bool program::get_startup_baseline(const isolation& isoltn, startup_baseline* basln) const
+{
+    static const std::map<language, std::pair<const char*, const char*>> empty_srcs = {
+            {language::C, {"empty.c", "int main(void)\n{\n    return 0;\n}\n"}},
+            {language::CPP, {"empty.cpp", "#include <iostream>\n\nint main()\n{\n    "
+                                          "return 0;\n}\n"}},
+            {language::BASH, {"empty.sh", "\n"}},
+            {language::PYTHON, {"empty.py", "\n"}},
+    };
     
-        strstream_str = strstream.str();
+    std::filesystem::path calib_dir = get_cache_path() / "calibration";
+    std::filesystem::path src_path;
+    std::vector<std::string> args;
+    std::string capt = capt_.substr(0, capt_.find(':')) == "file" ? "discard" : capt_;
+    std::string out_nme;
+    std::error_code err_code;
+    std::ofstream ofs;
+    program prog = *this;
+    hasher hshr;
+    bool is_tmp = false;
+    bool result;
     
-        std::cout << spd::ios::newl;
-        for (std::size_t i = 0; i < strstream_str.size(); i++)
+    if (empty_srcs.count(lang_) == 0)
+    {
+        return false;
+    }
+    
+    src_path = calib_dir / empty_srcs.at(lang_).first;
+    
+    if (!std::filesystem::exists(src_path, err_code))
+    {
+        std::filesystem::create_directories(calib_dir, err_code);
+        ofs.open(src_path, std::ios::trunc);
+        ofs << empty_srcs.at(lang_).second;
+        ofs.close();
+    }
+    
+    prog.fles_ = {src_path};
+    prog.pch_ = false;
+    prog.unity_ = false;
+    prog.build_prof_ = false;
+    prog.pgo_flgs_.clear();
+    prog.pgo_obj_dir_.clear();
+    
+    hshr.update(rec_.hostname);
+    hshr.update(rec_.kernel);
+    hshr.update(static_cast<std::uint64_t>(lang_));
+    
+    if (lang_ == language::C || lang_ == language::CPP)
+    {
+        hshr.update(prog.get_build_key(get_compiler_name()));
+    }
+    else
+    {
+        hshr.update(get_executable_id(lang_ == language::BASH ? "bash" : "python"));
+    }
+    
+    for (auto& x : isoltn.get_settings())
+    {
+        hshr.update(x);
+    }
+    
+    hshr.update(capt.substr(0, capt.find(':')));
+    
+    if (read_startup_baseline(calib_dir / hshr.get_hex_digest(), basln))
+    {
+        return true;
+    }
+    
+    if (lang_ == language::C || lang_ == language::CPP)
+    {
+        if (prog.build_executable(&out_nme, &is_tmp, "-empty") != 0)
         {
-            std::cout << "-";
+            std::cerr << "runsource: cannot build the calibration program, the timings are not "
+                         "adjusted" << spd::ios::newl;
+            return false;
         }
-        std::cout << spd::ios::newl
-                  << strstream_str
-                  << spd::ios::newl;
+        
+        args = {out_nme};
+    }
+    else
+    {
+        args = {lang_ == language::BASH ? "bash" : "python", src_path.string()};
+    }
+    
+    result = measure_startup_baseline(args, &isoltn, capt, basln);
+    
+    if (!result)
+    {
+        std::cerr << "runsource: cannot measure the startup baseline, the timings are not "
+                     "adjusted" << spd::ios::newl;
+    }
+    else
+    {
+        write_startup_baseline(calib_dir / hshr.get_hex_digest(), *basln);
+    }
+    
+    if (is_tmp)
+    {
+        remove_output_file(out_nme);
+    }
+    
+    return result;
+}
+
+
+int program::run_command(const std::vector<std::string>& args) const
+{
+    benchmark bench(repeat_, warmup_, precsn_, monotonic_chrn_, rsrc_usage_);
+    isolation isoltn = isoltn_;
+    output_capture captr(capt_);
+    bench_channel chnl;
+    bool use_chnl = uses_bench_header();
+    std::size_t n_launches = 0;
+    std::unique_ptr<perf_counters> countrs;
+    std::vector<std::string> meas_config;
+    history_entry entry;
+    startup_baseline basln;
+    bool calibrated = false;
+    std::vector<double> tmes;
+    int exec_result;
+    
+    if (countrs_)
+    {
+        countrs = std::make_unique<perf_counters>();
+    }
+    
+    if (!isoltn.enter())
+    {
+        return -1;
+    }
+    
+    exec_result = bench.run([&]() {
+        run_sample sample = run_sample();
+        
+        sample.exit_code = -1;
+        
+        if (captr.start())
+        {
+            if (!use_chnl || chnl.start())
+            {
+                launch(args, countrs.get(), &sample, captr.get_out_path(), std::string(), &isoltn,
+                       chnl.get_fd());
+                chnl.stop(n_launches >= warmup_);
+            }
+            
+            captr.stop(&sample);
+        }
+        
+        n_launches++;
+        
+        return sample;
+    });
+    
+    if (calib_ && exec_result == 0)
+    {
+        calibrated = get_startup_baseline(isoltn, &basln);
+    }
+    
+    isoltn.leave();
+    
+    captr.print_tail(std::cout);
+    bench.print_report(std::cout);
+    chnl.print_report(std::cout);
+    
+    if (calibrated)
+    {
+        for (auto& x : bench.get_samples())
+        {
+            tmes.push_back(monotonic_chrn_ ? x.wall_tme : x.cpu_tme);
+        }
+        
+        print_calibration(std::cout, basln, tmes, monotonic_chrn_);
+        
+        rec_.calibrated = true;
+        rec_.basln_wall_tme = basln.wall_tme;
+        rec_.basln_cpu_tme = basln.cpu_tme;
+        rec_.basln_runs = basln.runs;
+    }
+    
+    rec_.warmup = warmup_;
+    rec_.samples = bench.get_samples();
+    
+    if (exec_result == 0)
+    {
+        meas_config = isoltn.get_settings();
+        
+        if (!capt_.empty())
+        {
+            meas_config.push_back("capture=" + capt_.substr(0, capt_.find(':')));
+        }
+        
+        if (countrs_)
+        {
+            meas_config.emplace_back("counters");
+        }
+        
+        entry = make_history_entry(rec_, monotonic_chrn_, meas_config);
+    }
+    
+    if (is_comparable(entry))
+    {
+        compare_with_history(std::cout, read_history(get_cache_path() / "history.log"), entry);
+        append_history(get_cache_path() / "history.log", entry);
     }
     
     return exec_result;
 }
 
 
-void program::add_c_libs_to_link_from_file(
+void program::write_record() const
+{
+    std::ofstream ofs;
+    std::ostream* os = &std::cout;
+    std::error_code err_code;
+    bool hdr = true;
+    
+    if (!out_path_.empty())
+    {
+        hdr = !std::filesystem::exists(out_path_, err_code) ||
+              std::filesystem::file_size(out_path_, err_code) == 0;
+        
+        ofs.open(out_path_, std::ios::app);
+        if (!ofs)
+        {
+            std::cerr << "runsource: cannot open " << out_path_.string() << spd::ios::newl;
+            return;
+        }
+        
+        os = &ofs;
+    }
+    
+    if (frmt_ == "csv")
+    {
+        write_csv(*os, rec_, hdr);
+    }
+    else
+    {
+        write_json(*os, rec_);
+    }
+}
+
+
+int program::build_executable(
+        std::string* out_nme,
+        bool* is_tmp,
+        const std::string& tmp_sfx
+) const
+{
+    std::string ky;
+    std::filesystem::path entry_path;
+    std::filesystem::path stagng_path;
+    std::vector<std::filesystem::path> deps;
+    int result;
+    auto build = [&](const std::string& nme, std::vector<std::filesystem::path>* nme_deps) {
+        return lang_ == language::C ? build_c(nme, false, nme_deps) :
+                                      build_cpp(nme, false, nme_deps);
+    };
+    auto build_tmp = [&]() {
+        *out_nme = create_memory_file("runsource" + tmp_sfx);
+        
+        if (out_nme->empty())
+        {
+            *out_nme = spd::sys::fsys::get_tmp_path();
+            *out_nme += "/runsource-";
+            *out_nme += std::to_string(spd::sys::proc::get_pid());
+            *out_nme += tmp_sfx;
+        }
+        
+        result = build(*out_nme, nullptr);
+        *is_tmp = result == 0;
+        
+        if (result != 0)
+        {
+            remove_output_file(*out_nme);
+        }
+        
+        return result;
+    };
+    
+    *is_tmp = false;
+    
+    if (!cache_ || build_prof_ || !pgo_flgs_.empty())
+    {
+        return build_tmp();
+    }
+    
+    build_cache cache(get_cache_path(), cache_max_sze_);
+    ky = get_build_key(get_compiler_name());
+    
+    if (cache.find_up_to_date(ky, &entry_path))
+    {
+        cache.record_lookup(true);
+        rec_.cache_hit = true;
+        *is_tmp = false;
+        *out_nme = (entry_path / fles_.front().stem()).string();
+        
+        return 0;
+    }
+    
+    cache.record_lookup(false);
+    stagng_path = cache.create_staging_directory(ky);
+    if (stagng_path.empty())
+    {
+        return build_tmp();
+    }
+    
+    result = build((stagng_path / fles_.front().stem()).string(), &deps);
+    if (result != 0)
+    {
+        cache.discard(stagng_path);
+        return result;
+    }
+    
+    if (!build_cache::write_manifest(stagng_path, deps) ||
+        !cache.commit(ky, stagng_path, &entry_path))
+    {
+        cache.discard(stagng_path);
+        return build_tmp();
+    }
+    
+    cache.trim();
+    *out_nme = (entry_path / fles_.front().stem()).string();
+    
+    return 0;
+}
+
+
+std::string program::get_build_key(const std::string& comp_nme) const
+{
+    hasher hshr;
+    std::vector<std::filesystem::path> inc_dirs = get_include_directories();
+    std::set<std::filesystem::path> hdrs;
+    
+    hshr.update(get_executable_id(comp_nme));
+    hshr.update(static_cast<std::uint64_t>(lang_));
+    hshr.update(static_cast<std::uint64_t>(c_std_));
+    hshr.update(static_cast<std::uint64_t>(cpp_std_));
+    hshr.update(static_cast<std::uint64_t>(optmz_));
+    hshr.update(static_cast<std::uint64_t>(unity_));
+    hshr.update(static_cast<std::uint64_t>(lto_));
+    hshr.update(stdlib_);
+    hshr.update(get_linker());
+    hshr.update(comp_args_);
+    
+    if (!get_include_path().empty() && uses_bench_header())
+    {
+        hshr.update(get_include_path().string());
+    }
+    
+    for (auto& x : fles_)
+    {
+        hshr.update(x.string());
+        hshr.update_from_file(x);
+        add_local_headers_from_file(x, inc_dirs, hdrs);
+    }
+    
+    for (auto& x : hdrs)
+    {
+        hshr.update(x.string());
+        hshr.update_from_file(x);
+    }
+    
+    return hshr.get_hex_digest();
+}
+
+
+std::filesystem::path program::get_unity_source() const
+{
+    std::vector<name_collision> collisions;
+    std::filesystem::path unity_path;
+    hasher hshr;
+    
+    for (auto& x : fles_)
+    {
+        hshr.update(x.string());
+    }
+    
+    unity_path = get_cache_path() / "unity" / hshr.get_hex_digest();
+    unity_path += lang_ == language::C ? ".c" : ".cpp";
+    
+    if (!write_unity_source(unity_path, fles_, &collisions))
+    {
+        std::cerr << "runsource: cannot write " << unity_path.string() << spd::ios::newl;
+        return std::filesystem::path();
+    }
+    
+    for (auto& x : collisions)
+    {
+        std::cerr << "runsource: unity build: '" << x.nme << "' has internal linkage in";
+        
+        for (auto& y : x.fles)
+        {
+            std::cerr << " " << y.filename().string();
+        }
+        
+        std::cerr << ", renamed in each of them" << spd::ios::newl;
+    }
+    
+    return unity_path;
+}
+
+
+std::vector<std::filesystem::path> program::get_include_directories() const
+{
+    std::vector<std::filesystem::path> inc_dirs;
+    std::vector<std::string> args = split_arguments(comp_args_);
+    
+    for (std::size_t i = 0; i < args.size(); i++)
+    {
+        if ((args[i] == "-I" || args[i] == "-iquote" || args[i] == "-isystem") &&
+            i + 1 < args.size())
+        {
+            inc_dirs.emplace_back(std::filesystem::absolute(args[++i]));
+        }
+        else if (args[i].size() > 2 && args[i].compare(0, 2, "-I") == 0)
+        {
+            inc_dirs.emplace_back(std::filesystem::absolute(args[i].substr(2)));
+        }
+    }
+    
+    return inc_dirs;
+}
+
+
+void program::add_local_headers_from_file(
         const std::filesystem::path& fle_path,
-        std::unordered_set<std::string>& libs_to_link
+        const std::vector<std::filesystem::path>& inc_dirs,
+        std::set<std::filesystem::path>& hdrs
 ) const
 {
-    std::regex rgx_pragma(R"(^#pragma\ comment\(lib,.+\)$)");
-    std::regex rgx_lib(R"(\".+\")");
-    std::smatch smatch;
-    std::string curr_line;
-    std::ifstream ifs;
+    std::string hdr_nme;
+    std::filesystem::path hdr_path;
+    std::error_code err_code;
     
-    ifs.open(fle_path);
-    if (ifs)
+    for (auto& x : scan_directives(fle_path))
     {
-        while ((std::getline(ifs, curr_line), !ifs.eof()))
+        if (x.typ != directive_type::INCLUDE)
+        {
+            continue;
+        }
+        
+        hdr_nme = x.val.substr(1, x.val.size() - 2);
+        hdr_path.clear();
+        
+        if (x.val.front() == '"' &&
+            std::filesystem::is_regular_file(fle_path.parent_path() / hdr_nme, err_code))
+        {
+            hdr_path = fle_path.parent_path() / hdr_nme;
+        }
+        else
         {
-            if (std::regex_match(curr_line, rgx_pragma) &&
-                std::regex_search(curr_line, smatch, rgx_lib))
+            for (auto& y : inc_dirs)
             {
-                libs_to_link.insert(smatch.str());
+                if (std::filesystem::is_regular_file(y / hdr_nme, err_code))
+                {
+                    hdr_path = y / hdr_nme;
+                    break;
+                }
             }
         }
         
-        ifs.close();
+        if (!hdr_path.empty())
+        {
+            hdr_path = hdr_path.lexically_normal();
+            
+            if (hdrs.insert(hdr_path).second)
+            {
+                add_local_headers_from_file(hdr_path, inc_dirs, hdrs);
+            }
+        }
     }
 }
 
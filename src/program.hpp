@@ -24,13 +24,19 @@
 #ifndef RUNSOURCE_PROGRAM_HPP
 #define RUNSOURCE_PROGRAM_HPP
 
+#include <cstdint>
 #include <filesystem>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
+#include "build_profile.hpp"
 #include "c_standard.hpp"
+#include "calibration.hpp"
 #include "cpp_standard.hpp"
+#include "isolation.hpp"
 #include "language.hpp"
+#include "run_record.hpp"
 #include "tool_chain.hpp"
 
 
@@ -47,15 +53,72 @@ public:
             cpp_standard cpp_std,
             bool optmz,
             tool_chain tool_chn,
+            std::string stdlib,
+            std::string linker,
             std::string comp_args,
             std::string prog_args,
             bool monotonic_chrn,
+            bool cache,
+            std::uintmax_t cache_max_sze,
+            std::size_t jobs,
+            bool pch,
+            bool unity,
+            bool lto,
+            bool build_prof,
+            std::size_t repeat,
+            std::size_t warmup,
+            double precsn,
+            bool countrs,
+            bool rsrc_usage,
+            std::string capt,
+            bool calib,
+            std::vector<std::string> matrix,
+            bool cmp_tool_chns,
+            bool pgo,
+            std::string train_args,
+            bool batch,
+            bool serial,
+            bool watch,
+            isolation isoltn,
+            std::string frmt,
+            std::filesystem::path out_path,
             std::vector<std::filesystem::path> fles
     );
     
     int execute() const;
+    
+    int build(
+            std::vector<std::string>* args,
+            std::string* tmp_path,
+            const std::string& tmp_sfx = std::string()
+    ) const;
+    
+    const std::vector<std::filesystem::path>& get_files() const noexcept;
+    
+    void set_diagnostics_path(std::string diag_path);
 
 private:
+    int execute_comparison() const;
+    
+    int execute_pgo() const;
+    
+    int execute_watch() const;
+    
+    std::vector<std::filesystem::path> get_watched_files() const;
+    
+    int train_profile(const std::filesystem::path& prof_dir) const;
+    
+    int compare_variants(
+            std::vector<program> variants,
+            const std::vector<std::string>& nmes
+    ) const;
+    
+    std::vector<program> get_batch_programs() const;
+    
+    program get_variant(const std::string& variant) const;
+    
+    void init_record() const;
+    
     bool is_c() const noexcept;
     
     bool is_cpp() const noexcept;
@@ -64,21 +127,103 @@ private:
     
     bool is_python() const noexcept;
     
-    int gcc_build_c(const std::string& out_nme = std::string(), bool verb = true) const;
+    int build_c(
+            const std::string& out_nme = std::string(),
+            bool verb = true,
+            std::vector<std::filesystem::path>* deps = nullptr
+    ) const;
+    
+    int execute_c() const;
+    
+    int build_cpp(
+            const std::string& out_nme = std::string(),
+            bool verb = true,
+            std::vector<std::filesystem::path>* deps = nullptr
+    ) const;
+    
+    int execute_cpp() const;
+    
+    int build_sources(
+            const std::string& comp_nme,
+            const std::string& std_flg,
+            const std::string& out_nme,
+            double* pch_saved_tme = nullptr,
+            std::vector<std::filesystem::path>* deps = nullptr
+    ) const;
+    
+    int compile_object(
+            const std::string& comp_nme,
+            const std::vector<std::string>& flgs,
+            const std::filesystem::path& src_path,
+            const std::string& tmp_obj_path,
+            std::string* obj_path,
+            std::vector<std::filesystem::path>* deps = nullptr,
+            build_profile* prof = nullptr
+    ) const;
+    
+    void measure_header_costs(
+            const std::string& comp_nme,
+            const std::vector<std::string>& flgs,
+            build_profile* prof
+    ) const;
+    
+    void prepare_precompiled_headers(
+            const std::string& comp_nme,
+            const std::vector<std::string>& flgs,
+            std::vector<std::vector<std::string>>* pch_flgs,
+            double* pch_saved_tme
+    ) const;
+    
+    bool build_precompiled_header(
+            const std::string& comp_nme,
+            const std::vector<std::string>& flgs,
+            const std::string& hdr_content,
+            std::vector<std::string>* pch_flgs,
+            double* saved_tme
+    ) const;
+    
+    std::vector<std::string> get_leading_system_includes(
+            const std::filesystem::path& fle_path
+    ) const;
+    
+    std::string get_c_standard_flag() const;
     
-    int gcc_execute_c() const;
+    std::string get_cpp_standard_flag() const;
     
-    int gcc_build_cpp(const std::string& out_nme = std::string(), bool verb = true) const;
+    std::string get_compiler_name() const;
     
-    int gcc_execute_cpp() const;
+    std::string get_linker() const;
+    
+    std::string get_tool_chain_name() const;
     
     int execute_bash() const;
     
     int execute_python() const;
     
-    void add_c_libs_to_link_from_file(
+    bool uses_bench_header() const;
+    
+    bool get_startup_baseline(const isolation& isoltn, startup_baseline* basln) const;
+    
+    int run_command(const std::vector<std::string>& args) const;
+    
+    void write_record() const;
+    
+    int build_executable(
+            std::string* out_nme,
+            bool* is_tmp,
+            const std::string& tmp_sfx = std::string()
+    ) const;
+    
+    std::string get_build_key(const std::string& comp_nme) const;
+    
+    std::filesystem::path get_unity_source() const;
+    
+    std::vector<std::filesystem::path> get_include_directories() const;
+    
+    void add_local_headers_from_file(
             const std::filesystem::path& fle_path,
-            std::unordered_set<std::string>& libs_to_link
+            const std::vector<std::filesystem::path>& inc_dirs,
+            std::set<std::filesystem::path>& hdrs
     ) const;
 
 private:
@@ -94,14 +239,74 @@ private:
     
     tool_chain tool_chn_;
     
+    std::string stdlib_;
+    
+    std::string linker_;
+    
     std::string comp_args_;
     
     std::string prog_args_;
     
     bool monotonic_chrn_;
     
+    bool cache_;
+    
+    std::uintmax_t cache_max_sze_;
+    
+    std::size_t jobs_;
+    
+    bool pch_;
+    
+    bool unity_;
+    
+    bool lto_;
+    
+    bool build_prof_;
+    
+    std::size_t repeat_;
+    
+    std::size_t warmup_;
+    
+    double precsn_;
+    
+    bool countrs_;
+    
+    bool rsrc_usage_;
+    
+    std::string capt_;
+    
+    bool calib_;
+    
+    std::vector<std::string> matrix_;
+    
+    bool cmp_tool_chns_;
+    
+    bool pgo_;
+    
+    std::string train_args_;
+    
+    std::vector<std::string> pgo_flgs_;
+    
+    std::string pgo_obj_dir_;
+    
+    bool batch_;
+    
+    bool serial_;
+    
+    bool watch_;
+    
+    isolation isoltn_;
+    
+    std::string frmt_;
+    
+    std::filesystem::path out_path_;
+    
     std::vector<std::filesystem::path> fles_;
     
+    std::string diag_path_;
+    
+    mutable run_record rec_;
+    
     static std::unordered_set<std::string> c_exts_;
     
     static std::unordered_set<std::string> cpp_exts_;
@@ -0,0 +1,348 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include <sys/utsname.h>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "perf_counters.hpp"
+#include "run_record.hpp"
+
+
+namespace runsource {
+
+
+static std::string escape_json(const std::string& str)
+{
+    std::stringstream strstream;
+    
+    strstream << '"';
+    
+    for (auto& x : str)
+    {
+        switch (x)
+        {
+            case '"':
+                strstream << "\\\"";
+                break;
+            
+            case '\\':
+                strstream << "\\\\";
+                break;
+            
+            case '\n':
+                strstream << "\\n";
+                break;
+            
+            case '\t':
+                strstream << "\\t";
+                break;
+            
+            default:
+                if (static_cast<unsigned char>(x) < 0x20)
+                {
+                    strstream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                              << static_cast<int>(x) << std::dec;
+                }
+                else
+                {
+                    strstream << x;
+                }
+        }
+    }
+    
+    strstream << '"';
+    
+    return strstream.str();
+}
+
+
+static std::string escape_csv(const std::string& str)
+{
+    std::string escaped_str = "\"";
+    
+    for (auto& x : str)
+    {
+        escaped_str += x;
+        
+        if (x == '"')
+        {
+            escaped_str += '"';
+        }
+    }
+    
+    escaped_str += '"';
+    
+    return escaped_str;
+}
+
+
+void fill_host_info(run_record* rec)
+{
+    utsname uts;
+    std::time_t now = std::time(nullptr);
+    char buf[32];
+    
+    if (::uname(&uts) == 0)
+    {
+        rec->hostname = uts.nodename;
+        rec->kernel = std::string(uts.sysname) + " " + uts.release;
+        rec->machine = uts.machine;
+    }
+    
+    rec->cpus = std::thread::hardware_concurrency();
+    
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    rec->timestamp = buf;
+}
+
+
+void write_json(std::ostream& os, const run_record& rec)
+{
+    std::streamsize prev_precsn = os.precision(9);
+    
+    os << "{\"timestamp\":" << escape_json(rec.timestamp)
+       << ",\"language\":" << escape_json(rec.lang)
+       << ",\"tool_chain\":" << (rec.tool_chn.empty() ? "null" : escape_json(rec.tool_chn))
+       << ",\"standard\":" << (rec.standard.empty() ? "null" : escape_json(rec.standard))
+       << ",\"optimize\":" << (rec.optmz ? "true" : "false")
+       << ",\"flags\":[";
+    
+    for (std::size_t i = 0; i < rec.flgs.size(); i++)
+    {
+        os << (i == 0 ? "" : ",") << escape_json(rec.flgs[i]);
+    }
+    
+    os << "],\"build_command\":"
+       << (rec.build_command.empty() ? "null" : escape_json(rec.build_command))
+       << ",\"build_time\":";
+    
+    if (rec.tool_chn.empty())
+    {
+        os << "null";
+    }
+    else
+    {
+        os << rec.build_tme;
+    }
+    
+    os << ",\"linker\":" << (rec.linker.empty() ? "null" : escape_json(rec.linker))
+       << ",\"link_time\":";
+    
+    if (rec.tool_chn.empty() || rec.cache_hit)
+    {
+        os << "null";
+    }
+    else
+    {
+        os << rec.link_tme;
+    }
+    
+    os << ",\"cache_hit\":" << (rec.cache_hit ? "true" : "false")
+       << ",\"files\":[";
+    
+    for (std::size_t i = 0; i < rec.fle_hashes.size(); i++)
+    {
+        os << (i == 0 ? "" : ",")
+           << "{\"path\":" << escape_json(rec.fle_hashes[i].first)
+           << ",\"hash\":" << escape_json(rec.fle_hashes[i].second) << "}";
+    }
+    
+    os << "],\"host\":{\"hostname\":" << escape_json(rec.hostname)
+       << ",\"kernel\":" << escape_json(rec.kernel)
+       << ",\"machine\":" << escape_json(rec.machine)
+       << ",\"cpus\":" << rec.cpus
+       << "},\"warmup\":" << rec.warmup
+       << ",\"startup_baseline\":";
+    
+    if (rec.calibrated)
+    {
+        os << "{\"wall_time\":" << rec.basln_wall_tme
+           << ",\"cpu_time\":" << rec.basln_cpu_tme
+           << ",\"runs\":" << rec.basln_runs << "}";
+    }
+    else
+    {
+        os << "null";
+    }
+    
+    os << ",\"runs\":[";
+    
+    for (std::size_t i = 0; i < rec.samples.size(); i++)
+    {
+        const run_sample& sample = rec.samples[i];
+        
+        os << (i == 0 ? "" : ",")
+           << "{\"wall_time\":" << sample.wall_tme
+           << ",\"cpu_time\":" << sample.cpu_tme
+           << ",\"user_time\":" << sample.usr_tme
+           << ",\"system_time\":" << sample.sys_tme
+           << ",\"peak_rss_kib\":" << sample.peak_rss_kib
+           << ",\"minor_faults\":" << sample.minor_faults
+           << ",\"major_faults\":" << sample.major_faults
+           << ",\"voluntary_switches\":" << sample.vol_ctx_switches
+           << ",\"involuntary_switches\":" << sample.invol_ctx_switches
+           << ",\"block_reads\":" << sample.blk_reads
+           << ",\"block_writes\":" << sample.blk_writes
+           << ",\"exit_code\":" << sample.exit_code;
+        
+        if (rec.calibrated)
+        {
+            os << ",\"adjusted_wall_time\":" << sample.wall_tme - rec.basln_wall_tme
+               << ",\"adjusted_cpu_time\":" << sample.cpu_tme - rec.basln_cpu_tme;
+        }
+        
+        os << ",\"counters\":{";
+        
+        for (std::size_t j = 0; j < sample.countrs.size(); j++)
+        {
+            os << (j == 0 ? "" : ",") << escape_json(sample.countrs[j].first) << ":"
+               << sample.countrs[j].second;
+        }
+        
+        os << "}}";
+    }
+    
+    os << "]}" << spd::ios::newl;
+    os.precision(prev_precsn);
+}
+
+
+void write_csv(std::ostream& os, const run_record& rec, bool hdr)
+{
+    std::string flgs;
+    std::string fles;
+    std::vector<std::string> countr_nmes = perf_counters::get_event_names();
+    
+    if (hdr)
+    {
+        os << "timestamp,language,tool_chain,standard,optimize,flags,build_command,build_time,"
+              "linker,link_time,cache_hit,files,hostname,kernel,machine,cpus,warmup,iteration,"
+              "wall_time,cpu_time,user_time,system_time,peak_rss_kib,minor_faults,major_faults,"
+              "voluntary_switches,involuntary_switches,block_reads,block_writes,exit_code,"
+              "baseline_wall_time,baseline_cpu_time,adjusted_wall_time,adjusted_cpu_time";
+        
+        for (auto& x : countr_nmes)
+        {
+            os << ',' << x;
+        }
+        
+        os << spd::ios::newl;
+    }
+    
+    for (auto& x : rec.flgs)
+    {
+        flgs += flgs.empty() ? "" : " ";
+        flgs += x;
+    }
+    
+    for (auto& x : rec.fle_hashes)
+    {
+        fles += fles.empty() ? "" : ";";
+        fles += x.first + ":" + x.second;
+    }
+    
+    std::streamsize prev_precsn = os.precision(9);
+    
+    for (std::size_t i = 0; i < rec.samples.size(); i++)
+    {
+        const run_sample& sample = rec.samples[i];
+        
+        os << rec.timestamp << ','
+           << rec.lang << ','
+           << rec.tool_chn << ','
+           << rec.standard << ','
+           << (rec.optmz ? "true" : "false") << ','
+           << escape_csv(flgs) << ','
+           << escape_csv(rec.build_command) << ',';
+        
+        if (!rec.tool_chn.empty())
+        {
+            os << rec.build_tme;
+        }
+        
+        os << ',' << rec.linker << ',';
+        
+        if (!rec.tool_chn.empty() && !rec.cache_hit)
+        {
+            os << rec.link_tme;
+        }
+        
+        os << ','
+           << (rec.cache_hit ? "true" : "false") << ','
+           << escape_csv(fles) << ','
+           << escape_csv(rec.hostname) << ','
+           << escape_csv(rec.kernel) << ','
+           << rec.machine << ','
+           << rec.cpus << ','
+           << rec.warmup << ','
+           << i << ','
+           << sample.wall_tme << ','
+           << sample.cpu_tme << ','
+           << sample.usr_tme << ','
+           << sample.sys_tme << ','
+           << sample.peak_rss_kib << ','
+           << sample.minor_faults << ','
+           << sample.major_faults << ','
+           << sample.vol_ctx_switches << ','
+           << sample.invol_ctx_switches << ','
+           << sample.blk_reads << ','
+           << sample.blk_writes << ','
+           << sample.exit_code << ',';
+        
+        if (rec.calibrated)
+        {
+            os << rec.basln_wall_tme << ','
+               << rec.basln_cpu_tme << ','
+               << sample.wall_tme - rec.basln_wall_tme << ','
+               << sample.cpu_tme - rec.basln_cpu_tme;
+        }
+        else
+        {
+            os << ",,,";
+        }
+        
+        for (auto& x : countr_nmes)
+        {
+            os << ',';
+            
+            for (auto& y : sample.countrs)
+            {
+                if (y.first == x)
+                {
+                    os << y.second;
+                    break;
+                }
+            }
+        }
+        
+        os << spd::ios::newl;
+    }
+    
+    os.precision(prev_precsn);
+}
+
+
+}
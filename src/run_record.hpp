@@ -0,0 +1,95 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_RUN_RECORD_HPP
+#define RUNSOURCE_RUN_RECORD_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "run_sample.hpp"
+
+
+namespace runsource {
+
+
+struct run_record
+{
+    std::string timestamp;
+    
+    std::string lang;
+    
+    std::string tool_chn;
+    
+    std::string standard;
+    
+    bool optmz;
+    
+    std::vector<std::string> flgs;
+    
+    std::string build_command;
+    
+    double build_tme;
+    
+    std::string linker;
+    
+    double link_tme;
+    
+    bool cache_hit;
+    
+    std::vector<std::pair<std::string, std::string>> fle_hashes;
+    
+    std::string hostname;
+    
+    std::string kernel;
+    
+    std::string machine;
+    
+    unsigned int cpus;
+    
+    std::size_t warmup;
+    
+    bool calibrated;
+    
+    double basln_wall_tme;
+    
+    double basln_cpu_tme;
+    
+    std::size_t basln_runs;
+    
+    std::vector<run_sample> samples;
+};
+
+
+void fill_host_info(run_record* rec);
+
+
+void write_json(std::ostream& os, const run_record& rec);
+
+
+void write_csv(std::ostream& os, const run_record& rec, bool hdr);
+
+
+}
+
+
+#endif
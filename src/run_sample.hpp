@@ -0,0 +1,70 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_RUN_SAMPLE_HPP
+#define RUNSOURCE_RUN_SAMPLE_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace runsource {
+
+
+struct run_sample
+{
+    double wall_tme;
+    
+    double cpu_tme;
+    
+    double usr_tme;
+    
+    double sys_tme;
+    
+    long peak_rss_kib;
+    
+    long minor_faults;
+    
+    long major_faults;
+    
+    long vol_ctx_switches;
+    
+    long invol_ctx_switches;
+    
+    long blk_reads;
+    
+    long blk_writes;
+    
+    int exit_code;
+    
+    bool out_captured;
+    
+    long out_bytes;
+    
+    long out_lnes;
+    
+    std::vector<std::pair<std::string, double>> countrs;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,232 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "statistics.hpp"
+
+
+namespace runsource {
+
+
+sample_summary summarize(std::vector<double> samples)
+{
+    sample_summary summ = {};
+    double q1;
+    double q3;
+    double iqr;
+    double sum_sq = 0;
+    
+    summ.n = samples.size();
+    if (samples.empty())
+    {
+        return summ;
+    }
+    
+    std::sort(samples.begin(), samples.end());
+    
+    summ.min = samples.front();
+    summ.median = get_percentile(samples, 50);
+    summ.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    summ.p90 = get_percentile(samples, 90);
+    summ.p99 = get_percentile(samples, 99);
+    
+    for (auto& x : samples)
+    {
+        sum_sq += (x - summ.mean) * (x - summ.mean);
+    }
+    
+    summ.stddev = samples.size() > 1 ? std::sqrt(sum_sq / (samples.size() - 1)) : 0;
+    
+    q1 = get_percentile(samples, 25);
+    q3 = get_percentile(samples, 75);
+    iqr = q3 - q1;
+    
+    for (auto& x : samples)
+    {
+        if (x < q1 - 1.5 * iqr || x > q3 + 1.5 * iqr)
+        {
+            summ.outliers++;
+        }
+    }
+    
+    return summ;
+}
+
+
+double get_percentile(const std::vector<double>& sorted_samples, double percnt)
+{
+    double rank;
+    std::size_t lo;
+    
+    if (sorted_samples.empty())
+    {
+        return 0;
+    }
+    
+    rank = percnt / 100 * (sorted_samples.size() - 1);
+    lo = static_cast<std::size_t>(rank);
+    
+    if (lo + 1 >= sorted_samples.size())
+    {
+        return sorted_samples.back();
+    }
+    
+    return sorted_samples[lo] + (rank - lo) * (sorted_samples[lo + 1] - sorted_samples[lo]);
+}
+
+
+double get_confidence_half_width(const std::vector<double>& samples)
+{
+    static const double t_95[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    
+    std::size_t dof;
+    double t;
+    
+    if (samples.size() < 2)
+    {
+        return HUGE_VAL;
+    }
+    
+    dof = samples.size() - 1;
+    t = dof <= sizeof(t_95) / sizeof(t_95[0]) ? t_95[dof - 1] : 1.96;
+    
+    return t * summarize(samples).stddev / std::sqrt(static_cast<double>(samples.size()));
+}
+
+
+static double get_exact_u_probability(std::size_t n1, std::size_t n2, double u)
+{
+    std::vector<std::vector<std::vector<double>>> cnts(
+            n1 + 1, std::vector<std::vector<double>>(n2 + 1));
+    double le = 0;
+    double total = 0;
+    
+    for (std::size_t i = 0; i <= n1; i++)
+    {
+        for (std::size_t j = 0; j <= n2; j++)
+        {
+            cnts[i][j].assign(i * j + 1, 0);
+            
+            if (i == 0 || j == 0)
+            {
+                cnts[i][j][0] = 1;
+                continue;
+            }
+            
+            for (std::size_t k = 0; k <= i * j; k++)
+            {
+                cnts[i][j][k] = (k <= (i - 1) * j ? cnts[i - 1][j][k] : 0) +
+                                (k >= i ? cnts[i][j - 1][k - i] : 0);
+            }
+        }
+    }
+    
+    for (std::size_t k = 0; k <= n1 * n2; k++)
+    {
+        total += cnts[n1][n2][k];
+        le += k <= u ? cnts[n1][n2][k] : 0;
+    }
+    
+    return le / total;
+}
+
+
+rank_test_result mann_whitney_u_test(const std::vector<double>& x, const std::vector<double>& y)
+{
+    rank_test_result res = {0, 1, 0};
+    std::vector<std::pair<double, bool>> vals;
+    std::vector<double> rnks;
+    std::size_t n1 = x.size();
+    std::size_t n2 = y.size();
+    std::size_t n = n1 + n2;
+    std::size_t j;
+    double rnk_sum = 0;
+    double tie_sum = 0;
+    double mu;
+    double sigma;
+    double z;
+    
+    if (n1 == 0 || n2 == 0)
+    {
+        return res;
+    }
+    
+    for (auto& v : x)
+    {
+        vals.emplace_back(v, true);
+    }
+    
+    for (auto& v : y)
+    {
+        vals.emplace_back(v, false);
+    }
+    
+    std::sort(vals.begin(), vals.end());
+    rnks.resize(n);
+    
+    for (std::size_t i = 0; i < n; i = j)
+    {
+        for (j = i + 1; j < n && vals[j].first == vals[i].first; j++)
+        {
+        }
+        
+        for (std::size_t k = i; k < j; k++)
+        {
+            rnks[k] = (i + j + 1) / 2.0;
+        }
+        
+        tie_sum += std::pow(static_cast<double>(j - i), 3) - static_cast<double>(j - i);
+    }
+    
+    for (std::size_t i = 0; i < n; i++)
+    {
+        rnk_sum += vals[i].second ? rnks[i] : 0;
+    }
+    
+    res.u = rnk_sum - n1 * (n1 + 1) / 2.0;
+    res.effect_sze = 2 * res.u / (static_cast<double>(n1) * n2) - 1;
+    
+    if (tie_sum == 0 && n1 <= 20 && n2 <= 20)
+    {
+        res.p_value = std::min(1.0, 2 * get_exact_u_probability(
+                n1, n2, std::min(res.u, n1 * n2 - res.u)));
+        return res;
+    }
+    
+    mu = n1 * n2 / 2.0;
+    sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1) - tie_sum / (static_cast<double>(n) * (n - 1))));
+    
+    if (sigma > 0)
+    {
+        z = std::max(0.0, std::abs(res.u - mu) - 0.5) / sigma;
+        res.p_value = std::erfc(z / std::sqrt(2.0));
+    }
+    
+    return res;
+}
+
+
+}
@@ -0,0 +1,75 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_STATISTICS_HPP
+#define RUNSOURCE_STATISTICS_HPP
+
+#include <cstddef>
+#include <vector>
+
+
+namespace runsource {
+
+
+struct sample_summary
+{
+    std::size_t n;
+    
+    double min;
+    
+    double median;
+    
+    double mean;
+    
+    double stddev;
+    
+    double p90;
+    
+    double p99;
+    
+    std::size_t outliers;
+};
+
+
+struct rank_test_result
+{
+    double u;
+    
+    double p_value;
+    
+    double effect_sze;
+};
+
+
+sample_summary summarize(std::vector<double> samples);
+
+
+double get_percentile(const std::vector<double>& sorted_samples, double percnt);
+
+
+double get_confidence_half_width(const std::vector<double>& samples);
+
+
+rank_test_result mann_whitney_u_test(const std::vector<double>& x, const std::vector<double>& y);
+
+
+}
+
+
+#endif
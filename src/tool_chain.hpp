@@ -32,6 +32,7 @@ enum class tool_chain
 {
     NIL,
     GCC,
+    CLANG,
 };
 
 
@@ -0,0 +1,394 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+
+#include <speed/speed.hpp>
+#include <speed/speed_alias.hpp>
+
+#include "directive_scanner.hpp"
+#include "unity_build.hpp"
+
+
+namespace runsource {
+
+
+enum class scope_kind
+{
+    NIL,
+    NAMESPACE,
+    ANONYMOUS_NAMESPACE,
+    OTHER,
+};
+
+
+static bool is_identifier(const std::string& tok)
+{
+    return !tok.empty() && (std::isalpha(static_cast<unsigned char>(tok[0])) || tok[0] == '_');
+}
+
+
+static std::vector<std::string> tokenize(const std::string& src)
+{
+    std::vector<std::string> toks;
+    std::size_t i = 0;
+    std::size_t j;
+    std::size_t n = src.size();
+    bool line_beg = true;
+    
+    while (i < n)
+    {
+        char c = src[i];
+        
+        if (c == '\n')
+        {
+            line_beg = true;
+            i++;
+        }
+        else if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            i++;
+        }
+        else if (c == '/' && i + 1 < n && src[i + 1] == '/')
+        {
+            i = src.find('\n', i);
+            i = i == std::string::npos ? n : i;
+        }
+        else if (c == '/' && i + 1 < n && src[i + 1] == '*')
+        {
+            i = src.find("*/", i + 2);
+            i = i == std::string::npos ? n : i + 2;
+        }
+        else if (c == '#' && line_beg)
+        {
+            while (i < n && (src[i] != '\n' || src[i - 1] == '\\'))
+            {
+                i++;
+            }
+        }
+        else if (c == '"' || c == '\'')
+        {
+            for (i++; i < n && src[i] != c && src[i] != '\n'; i++)
+            {
+                i += src[i] == '\\' ? 1 : 0;
+            }
+            
+            i++;
+            toks.emplace_back("\"\"");
+            line_beg = false;
+        }
+        else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_')
+        {
+            for (j = i; j < n && (std::isalnum(static_cast<unsigned char>(src[j])) ||
+                                  src[j] == '_' || (std::isdigit(static_cast<unsigned char>(c)) &&
+                                                    (src[j] == '.' || src[j] == '\''))); j++)
+            {
+            }
+            
+            if (j < n && src[j] == '"' && src[j - 1] == 'R')
+            {
+                std::size_t open = src.find('(', j);
+                std::string delim = ")" + src.substr(j + 1, open - j - 1) + "\"";
+                
+                j = open == std::string::npos ? n : src.find(delim, open);
+                j = j == std::string::npos ? n : j + delim.size();
+                toks.emplace_back("\"\"");
+            }
+            else
+            {
+                toks.push_back(src.substr(i, j - i));
+            }
+            
+            i = j;
+            line_beg = false;
+        }
+        else if (c == ':' && i + 1 < n && src[i + 1] == ':')
+        {
+            toks.emplace_back("::");
+            i += 2;
+            line_beg = false;
+        }
+        else
+        {
+            toks.emplace_back(1, c);
+            i++;
+            line_beg = false;
+        }
+    }
+    
+    return toks;
+}
+
+
+static std::string get_declared_name(const std::vector<std::string>& stmt, bool in_anon)
+{
+    static const std::set<std::string> kwrds = {
+            "alignas", "auto", "bool", "char", "const", "constexpr", "double", "extern", "final",
+            "float", "inline", "int", "long", "noexcept", "operator", "override", "short",
+            "signed", "static", "thread_local", "unsigned", "void", "volatile",
+    };
+    
+    std::size_t end = 0;
+    bool is_static = std::find(stmt.begin(), stmt.end(), "static") != stmt.end();
+    
+    if (stmt.empty() || (!is_static && !in_anon))
+    {
+        return std::string();
+    }
+    
+    if (stmt.front() == "using")
+    {
+        return stmt.size() >= 3 && stmt[2] == "=" ? stmt[1] : std::string();
+    }
+    
+    if (!is_static && stmt.front() != "typedef")
+    {
+        for (std::size_t i = 0; i + 1 < stmt.size(); i++)
+        {
+            if (stmt[i] == "struct" || stmt[i] == "class" || stmt[i] == "union" ||
+                stmt[i] == "enum")
+            {
+                i += stmt[i + 1] == "class" || stmt[i + 1] == "struct" ? 1 : 0;
+                
+                return i + 1 < stmt.size() && is_identifier(stmt[i + 1]) &&
+                       std::find(stmt.begin(), stmt.end(), "(") == stmt.end() ?
+                       stmt[i + 1] : std::string();
+            }
+        }
+    }
+    
+    while (end < stmt.size() && stmt[end] != "(" && stmt[end] != "=" && stmt[end] != "[" &&
+           stmt[end] != "{" && stmt[end] != "," && stmt[end] != ":")
+    {
+        end++;
+    }
+    
+    if (end == 0 || !is_identifier(stmt[end - 1]) || kwrds.count(stmt[end - 1]) != 0 ||
+        (end >= 2 && (stmt[end - 2] == "::" || stmt[end - 2] == "operator")))
+    {
+        return std::string();
+    }
+    
+    return stmt[end - 1];
+}
+
+
+std::vector<std::string> scan_internal_names(const std::filesystem::path& fle_path)
+{
+    std::ifstream ifs(fle_path);
+    std::string src((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::vector<scope_kind> scopes;
+    std::vector<std::string> stmt;
+    std::set<std::string> nmes;
+    std::string nme;
+    int paren_depth = 0;
+    auto at_namespace_scope = [&]() {
+        return std::all_of(scopes.begin(), scopes.end(), [](scope_kind x) {
+            return x != scope_kind::OTHER;
+        });
+    };
+    auto in_anon_namespace = [&]() {
+        return std::find(scopes.begin(), scopes.end(), scope_kind::ANONYMOUS_NAMESPACE) !=
+               scopes.end();
+    };
+    auto end_statement = [&]() {
+        nme = get_declared_name(stmt, in_anon_namespace());
+        
+        if (!nme.empty())
+        {
+            nmes.insert(nme);
+        }
+        
+        stmt.clear();
+        paren_depth = 0;
+    };
+    
+    for (auto& x : tokenize(src))
+    {
+        if (!at_namespace_scope())
+        {
+            if (x == "{")
+            {
+                scopes.push_back(scope_kind::OTHER);
+            }
+            else if (x == "}")
+            {
+                scopes.pop_back();
+            }
+        }
+        else if (x == "(" || x == ")")
+        {
+            paren_depth += x == "(" ? 1 : -1;
+            stmt.push_back(x);
+        }
+        else if (x == "{" && paren_depth == 0)
+        {
+            if (!stmt.empty() && (stmt.back() == "namespace" ||
+                                  (stmt.size() == 2 && stmt[0] == "extern")))
+            {
+                scopes.push_back(stmt.back() == "namespace" ? scope_kind::ANONYMOUS_NAMESPACE :
+                                 scope_kind::NAMESPACE);
+                stmt.clear();
+            }
+            else if (std::find(stmt.begin(), stmt.end(), "namespace") != stmt.end())
+            {
+                scopes.push_back(scope_kind::NAMESPACE);
+                stmt.clear();
+            }
+            else
+            {
+                stmt.push_back(x);
+                end_statement();
+                scopes.push_back(scope_kind::OTHER);
+            }
+        }
+        else if (x == "}")
+        {
+            stmt.clear();
+            
+            if (!scopes.empty())
+            {
+                scopes.pop_back();
+            }
+        }
+        else if (x == ";" && paren_depth == 0)
+        {
+            end_statement();
+        }
+        else
+        {
+            stmt.push_back(x);
+        }
+    }
+    
+    return std::vector<std::string>(nmes.begin(), nmes.end());
+}
+
+
+std::string generate_unity_source(
+        const std::vector<std::filesystem::path>& fles,
+        std::vector<name_collision>* collisions
+)
+{
+    std::map<std::string, std::vector<std::size_t>> fles_by_nme;
+    std::vector<std::vector<std::string>> renames(fles.size());
+    std::set<std::string> sys_incs;
+    std::string src = "/* Generated by runsource, do not edit. */\n";
+    
+    for (std::size_t i = 0; i < fles.size(); i++)
+    {
+        for (auto& x : scan_internal_names(fles[i]))
+        {
+            fles_by_nme[x].push_back(i);
+        }
+    }
+    
+    for (auto& x : fles_by_nme)
+    {
+        if (x.second.size() < 2)
+        {
+            continue;
+        }
+        
+        collisions->push_back({x.first, {}});
+        
+        for (auto& y : x.second)
+        {
+            collisions->back().fles.push_back(fles[y]);
+            renames[y].push_back(x.first);
+        }
+    }
+    
+    for (std::size_t i = 0; i < fles.size() && !collisions->empty(); i++)
+    {
+        for (auto& x : scan_directives(fles[i]))
+        {
+            if (x.typ == directive_type::INCLUDE && x.val.front() == '<' &&
+                sys_incs.insert(x.val).second)
+            {
+                src += "#include " + x.val + "\n";
+            }
+        }
+    }
+    
+    for (std::size_t i = 0; i < fles.size(); i++)
+    {
+        for (auto& x : renames[i])
+        {
+            src += "#define " + x + " " + x + "_runsource_unity_" + std::to_string(i) + "\n";
+        }
+        
+        src += "#include \"" + fles[i].string() + "\"\n";
+        
+        for (auto& x : renames[i])
+        {
+            src += "#undef " + x + "\n";
+        }
+    }
+    
+    return src;
+}
+
+
+bool write_unity_source(
+        const std::filesystem::path& unity_path,
+        const std::vector<std::filesystem::path>& fles,
+        std::vector<name_collision>* collisions
+)
+{
+    static std::atomic<unsigned int> n_writes(0);
+    std::string src = generate_unity_source(fles, collisions);
+    std::ifstream ifs(unity_path);
+    std::string cur_src((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::filesystem::path tmp_path = unity_path;
+    std::error_code err_code;
+    std::ofstream ofs;
+    
+    if (ifs && cur_src == src)
+    {
+        return true;
+    }
+    
+    tmp_path += "." + std::to_string(spd::sys::proc::get_pid()) + "-" +
+                std::to_string(n_writes++) + ".tmp";
+    
+    std::filesystem::create_directories(unity_path.parent_path(), err_code);
+    ofs.open(tmp_path, std::ios::trunc);
+    ofs << src;
+    ofs.close();
+    
+    if (!ofs)
+    {
+        std::filesystem::remove(tmp_path, err_code);
+        return false;
+    }
+    
+    std::filesystem::rename(tmp_path, unity_path, err_code);
+    
+    return !err_code;
+}
+
+
+}
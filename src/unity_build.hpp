@@ -0,0 +1,58 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_UNITY_BUILD_HPP
+#define RUNSOURCE_UNITY_BUILD_HPP
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace runsource {
+
+
+struct name_collision
+{
+    std::string nme;
+    
+    std::vector<std::filesystem::path> fles;
+};
+
+
+std::vector<std::string> scan_internal_names(const std::filesystem::path& fle_path);
+
+
+std::string generate_unity_source(
+        const std::vector<std::filesystem::path>& fles,
+        std::vector<name_collision>* collisions
+);
+
+
+bool write_unity_source(
+        const std::filesystem::path& unity_path,
+        const std::vector<std::filesystem::path>& fles,
+        std::vector<name_collision>* collisions
+);
+
+
+}
+
+
+#endif
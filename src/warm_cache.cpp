@@ -0,0 +1,252 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "warm_cache.hpp"
+
+
+namespace runsource {
+
+
+static constexpr std::uint64_t max_val_sze = 16u << 20;
+
+
+static std::filesystem::path warm_sock_path;
+
+
+static bool write_fully(int fd, const void* buf, std::size_t sze)
+{
+    const char* cur = static_cast<const char*>(buf);
+    ssize_t n;
+    
+    while (sze > 0)
+    {
+        n = ::send(fd, cur, sze, MSG_NOSIGNAL);
+        
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        
+        if (n <= 0)
+        {
+            return false;
+        }
+        
+        cur += n;
+        sze -= n;
+    }
+    
+    return true;
+}
+
+
+static bool read_fully(int fd, void* buf, std::size_t sze)
+{
+    char* cur = static_cast<char*>(buf);
+    ssize_t n;
+    
+    while (sze > 0)
+    {
+        n = ::read(fd, cur, sze);
+        
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        
+        if (n <= 0)
+        {
+            return false;
+        }
+        
+        cur += n;
+        sze -= n;
+    }
+    
+    return true;
+}
+
+
+static int send_message(const message_header& hdr, const std::string& ky, const std::string& val)
+{
+    sockaddr_un addr = {};
+    int fd;
+    
+    if (warm_sock_path.empty() || warm_sock_path.string().size() >= sizeof(addr.sun_path))
+    {
+        return -1;
+    }
+    
+    addr.sun_family = AF_UNIX;
+    warm_sock_path.string().copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        !write_fully(fd, &hdr, sizeof(hdr)) ||
+        !write_fully(fd, ky.data(), ky.size()) ||
+        !write_fully(fd, val.data(), val.size()))
+    {
+        ::close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+
+warm_cache::warm_cache(std::size_t max_sze)
+        : entries_()
+        , sze_(0)
+        , max_sze_(max_sze)
+{
+}
+
+
+bool warm_cache::find(const std::string& ky, std::string* val) const
+{
+    auto it = entries_.find(ky);
+    
+    if (it == entries_.end())
+    {
+        return false;
+    }
+    
+    *val = it->second;
+    
+    return true;
+}
+
+
+void warm_cache::insert(const std::string& ky, std::string val)
+{
+    auto it = entries_.find(ky);
+    
+    if (it != entries_.end())
+    {
+        sze_ -= it->first.size() + it->second.size();
+        entries_.erase(it);
+    }
+    
+    if (sze_ + ky.size() + val.size() > max_sze_)
+    {
+        entries_.clear();
+        sze_ = 0;
+    }
+    
+    sze_ += ky.size() + val.size();
+    entries_.emplace(ky, std::move(val));
+}
+
+
+void warm_cache::serve(int fd, const message_header& hdr)
+{
+    std::string ky(hdr.ky_sze, '\0');
+    std::string val;
+    std::uint64_t val_sze;
+    
+    if (hdr.ky_sze > max_val_sze || hdr.sze > max_val_sze || !read_fully(fd, ky.data(), ky.size()))
+    {
+        return;
+    }
+    
+    if (hdr.kind == message_kind::LOOKUP)
+    {
+        val_sze = find(ky, &val) ? val.size() : ~std::uint64_t(0);
+        
+        if (write_fully(fd, &val_sze, sizeof(val_sze)))
+        {
+            write_fully(fd, val.data(), val.size());
+        }
+    }
+    else if (hdr.kind == message_kind::STORE)
+    {
+        val.resize(hdr.sze);
+        
+        if (read_fully(fd, val.data(), val.size()))
+        {
+            insert(ky, std::move(val));
+        }
+    }
+}
+
+
+void set_warm_cache_path(std::filesystem::path sock_path)
+{
+    warm_sock_path = std::move(sock_path);
+}
+
+
+bool lookup_warm_value(const std::string& ky, std::string* val)
+{
+    message_header hdr = {message_kind::LOOKUP, 0, static_cast<std::uint32_t>(ky.size()), 0};
+    std::uint64_t val_sze;
+    bool found;
+    int fd;
+    
+    fd = send_message(hdr, ky, std::string());
+    if (fd < 0)
+    {
+        return false;
+    }
+    
+    found = read_fully(fd, &val_sze, sizeof(val_sze)) && val_sze <= max_val_sze;
+    
+    if (found)
+    {
+        val->resize(val_sze);
+        found = read_fully(fd, val->data(), val->size());
+    }
+    
+    ::close(fd);
+    
+    return found;
+}
+
+
+void store_warm_value(const std::string& ky, const std::string& val)
+{
+    message_header hdr = {message_kind::STORE, 0, static_cast<std::uint32_t>(ky.size()),
+                          val.size()};
+    int fd;
+    
+    if (val.size() > max_val_sze)
+    {
+        return;
+    }
+    
+    fd = send_message(hdr, ky, val);
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+
+}
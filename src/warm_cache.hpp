@@ -0,0 +1,86 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_WARM_CACHE_HPP
+#define RUNSOURCE_WARM_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+
+namespace runsource {
+
+
+enum class message_kind : std::uint32_t
+{
+    NIL,
+    RUN,
+    LOOKUP,
+    STORE,
+};
+
+
+struct message_header
+{
+    message_kind kind;
+    
+    std::uint32_t n_args;
+    
+    std::uint32_t ky_sze;
+    
+    std::uint64_t sze;
+};
+
+
+class warm_cache
+{
+public:
+    explicit warm_cache(std::size_t max_sze);
+    
+    bool find(const std::string& ky, std::string* val) const;
+    
+    void insert(const std::string& ky, std::string val);
+    
+    void serve(int fd, const message_header& hdr);
+
+private:
+    std::map<std::string, std::string> entries_;
+    
+    std::size_t sze_;
+    
+    std::size_t max_sze_;
+};
+
+
+void set_warm_cache_path(std::filesystem::path sock_path);
+
+
+bool lookup_warm_value(const std::string& ky, std::string* val);
+
+
+void store_warm_value(const std::string& ky, const std::string& val);
+
+
+}
+
+
+#endif
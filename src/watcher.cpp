@@ -0,0 +1,145 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "watcher.hpp"
+
+
+namespace runsource {
+
+
+watcher::watcher()
+        : fd_(::inotify_init1(IN_CLOEXEC | IN_NONBLOCK))
+        , dirs_()
+        , dirs_by_wd_()
+        , fles_()
+        , failed_(false)
+{
+}
+
+
+watcher::~watcher()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+
+bool watcher::is_valid() const noexcept
+{
+    return fd_ >= 0 && !failed_;
+}
+
+
+bool watcher::watch(const std::vector<std::filesystem::path>& fles)
+{
+    int wd;
+    
+    fles_.clear();
+    
+    for (auto& x : fles)
+    {
+        if (dirs_.count(x.parent_path()) == 0)
+        {
+            wd = ::inotify_add_watch(fd_, x.parent_path().c_str(),
+                                     IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+            if (wd < 0)
+            {
+                return false;
+            }
+            
+            dirs_[x.parent_path()] = wd;
+            dirs_by_wd_[wd] = x.parent_path();
+        }
+        
+        fles_.insert(x);
+    }
+    
+    return true;
+}
+
+
+bool watcher::wait_for_change(int timeout_ms)
+{
+    alignas(inotify_event) char buf[4096];
+    const inotify_event* evnt;
+    pollfd pfd = {fd_, POLLIN, 0};
+    ssize_t len;
+    int res;
+    bool changed = false;
+    
+    while (!changed)
+    {
+        res = ::poll(&pfd, 1, timeout_ms);
+        
+        if (res <= 0)
+        {
+            failed_ = failed_ || (res < 0 && errno != EINTR);
+            return false;
+        }
+        
+        while ((len = ::read(fd_, buf, sizeof(buf))) > 0)
+        {
+            for (char* cur = buf; cur < buf + len; cur += sizeof(inotify_event) + evnt->len)
+            {
+                evnt = reinterpret_cast<const inotify_event*>(cur);
+                
+                if ((evnt->mask & IN_Q_OVERFLOW) != 0)
+                {
+                    changed = true;
+                }
+                else if ((evnt->mask & IN_IGNORED) != 0 && dirs_by_wd_.count(evnt->wd) != 0)
+                {
+                    dirs_.erase(dirs_by_wd_[evnt->wd]);
+                    dirs_by_wd_.erase(evnt->wd);
+                    changed = true;
+                }
+                else if (evnt->len > 0 && dirs_by_wd_.count(evnt->wd) != 0 &&
+                         fles_.count(dirs_by_wd_[evnt->wd] / evnt->name) != 0)
+                {
+                    changed = true;
+                }
+            }
+        }
+        
+        if (len < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            failed_ = true;
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+
+std::size_t watcher::get_n_files() const noexcept
+{
+    return fles_.size();
+}
+
+
+}
@@ -0,0 +1,67 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_WATCHER_HPP
+#define RUNSOURCE_WATCHER_HPP
+
+#include <filesystem>
+#include <map>
+#include <set>
+#include <vector>
+
+
+namespace runsource {
+
+
+class watcher
+{
+public:
+    watcher();
+    
+    watcher(const watcher& rhs) = delete;
+    
+    ~watcher();
+    
+    watcher& operator=(const watcher& rhs) = delete;
+    
+    bool is_valid() const noexcept;
+    
+    bool watch(const std::vector<std::filesystem::path>& fles);
+    
+    bool wait_for_change(int timeout_ms);
+    
+    std::size_t get_n_files() const noexcept;
+
+private:
+    int fd_;
+    
+    std::map<std::filesystem::path, int> dirs_;
+    
+    std::map<int, std::filesystem::path> dirs_by_wd_;
+    
+    std::set<std::filesystem::path> fles_;
+    
+    bool failed_;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,219 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/build_cache.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static std::filesystem::path add_entry(
+        rs::build_cache* cache,
+        const std::string& ky,
+        std::size_t sze,
+        std::chrono::hours age
+)
+{
+    std::filesystem::path stagng_path = cache->create_staging_directory(ky);
+    std::filesystem::path entry_path;
+    
+    std::ofstream(stagng_path / "program") << std::string(sze, 'x');
+    cache->commit(ky, stagng_path, &entry_path);
+    std::filesystem::last_write_time(entry_path,
+                                     std::filesystem::file_time_type::clock::now() - age);
+    
+    return entry_path;
+}
+
+
+static void test_commit_and_find()
+{
+    std::filesystem::path root_path = rs::tests::make_temp_directory("build-cache-test");
+    rs::build_cache cache(root_path, 1024);
+    std::filesystem::path entry_path;
+    std::filesystem::path found_path;
+    
+    RUNSOURCE_CHECK(!cache.find("0123456789abcdef", &found_path));
+    
+    entry_path = add_entry(&cache, "0123456789abcdef", 10, std::chrono::hours(0));
+    
+    RUNSOURCE_CHECK(cache.find("0123456789abcdef", &found_path));
+    RUNSOURCE_CHECK(found_path == entry_path);
+    RUNSOURCE_CHECK(std::filesystem::exists(found_path / "program"));
+    RUNSOURCE_CHECK(!std::filesystem::exists(root_path / "staging" / "0123456789abcdef"));
+    
+    std::filesystem::remove_all(root_path);
+}
+
+
+static void test_commit_keeps_up_to_date_entry()
+{
+    std::filesystem::path root_path = rs::tests::make_temp_directory("build-cache-test");
+    rs::build_cache cache(root_path, 1024);
+    std::filesystem::path entry_path = add_entry(&cache, "dd00", 10, std::chrono::hours(0));
+    std::filesystem::path stagng_path;
+    std::filesystem::path found_path;
+    
+    RUNSOURCE_CHECK(rs::build_cache::write_manifest(entry_path, {}));
+    
+    stagng_path = cache.create_staging_directory("dd00");
+    std::ofstream(stagng_path / "program") << std::string(20, 'y');
+    
+    RUNSOURCE_CHECK(cache.commit("dd00", stagng_path, &found_path));
+    RUNSOURCE_CHECK(found_path == entry_path);
+    RUNSOURCE_CHECK(std::filesystem::file_size(entry_path / "program") == 10);
+    RUNSOURCE_CHECK(!std::filesystem::exists(stagng_path));
+    
+    std::filesystem::remove(entry_path / "manifest");
+    stagng_path = cache.create_staging_directory("dd00");
+    std::ofstream(stagng_path / "program") << std::string(20, 'y');
+    
+    RUNSOURCE_CHECK(cache.commit("dd00", stagng_path, &found_path));
+    RUNSOURCE_CHECK(std::filesystem::file_size(entry_path / "program") == 20);
+    RUNSOURCE_CHECK(std::filesystem::is_empty(root_path / "staging"));
+    
+    std::filesystem::remove_all(root_path);
+}
+
+
+static void test_trim_evicts_least_recently_used()
+{
+    std::filesystem::path root_path = rs::tests::make_temp_directory("build-cache-test");
+    rs::build_cache cache(root_path, 250);
+    std::filesystem::path old_path = add_entry(&cache, "aa00", 100, std::chrono::hours(3));
+    std::filesystem::path mid_path = add_entry(&cache, "bb00", 100, std::chrono::hours(2));
+    std::filesystem::path new_path = add_entry(&cache, "cc00", 100, std::chrono::hours(1));
+    
+    RUNSOURCE_CHECK(cache.find("aa00", nullptr));
+    
+    cache.trim();
+    
+    RUNSOURCE_CHECK(std::filesystem::exists(old_path));
+    RUNSOURCE_CHECK(!std::filesystem::exists(mid_path));
+    RUNSOURCE_CHECK(std::filesystem::exists(new_path));
+    
+    cache.trim();
+    
+    RUNSOURCE_CHECK(std::filesystem::exists(old_path));
+    RUNSOURCE_CHECK(std::filesystem::exists(new_path));
+    
+    std::filesystem::remove_all(root_path);
+}
+
+
+static void test_manifest()
+{
+    std::filesystem::path root_path = rs::tests::make_temp_directory("build-cache-test");
+    std::filesystem::path dep_path = root_path / "dir with spaces" / "header.hpp";
+    std::vector<std::filesystem::path> deps;
+    
+    std::filesystem::create_directories(dep_path.parent_path());
+    std::ofstream(dep_path) << "#define VAL 1\n";
+    
+    RUNSOURCE_CHECK(!rs::build_cache::is_manifest_up_to_date(root_path));
+    RUNSOURCE_CHECK(rs::build_cache::write_manifest(root_path, {dep_path}));
+    RUNSOURCE_CHECK(rs::build_cache::read_manifest(root_path, &deps));
+    RUNSOURCE_CHECK(deps == std::vector<std::filesystem::path>{dep_path});
+    RUNSOURCE_CHECK(rs::build_cache::is_manifest_up_to_date(root_path));
+    
+    std::filesystem::last_write_time(dep_path, std::filesystem::file_time_type::clock::now() +
+                                               std::chrono::hours(1));
+    
+    RUNSOURCE_CHECK(rs::build_cache::is_manifest_up_to_date(root_path));
+    
+    std::ofstream(dep_path) << "#define VAL 2\n";
+    
+    RUNSOURCE_CHECK(!rs::build_cache::is_manifest_up_to_date(root_path));
+    
+    std::filesystem::remove(dep_path);
+    
+    RUNSOURCE_CHECK(!rs::build_cache::is_manifest_up_to_date(root_path));
+    RUNSOURCE_CHECK(!rs::build_cache::write_manifest(root_path, {dep_path}));
+    
+    std::filesystem::remove_all(root_path);
+}
+
+
+static void test_trim_skips_recent_entries()
+{
+    std::filesystem::path root_path = rs::tests::make_temp_directory("build-cache-test");
+    rs::build_cache cache(root_path, 150);
+    std::filesystem::path old_path = add_entry(&cache, "ee00", 100, std::chrono::hours(1));
+    std::filesystem::path new_path = add_entry(&cache, "ff00", 100, std::chrono::hours(0));
+    std::filesystem::path newer_path = add_entry(&cache, "ff11", 100, std::chrono::hours(0));
+    
+    cache.trim();
+    
+    RUNSOURCE_CHECK(!std::filesystem::exists(old_path));
+    RUNSOURCE_CHECK(std::filesystem::exists(new_path));
+    RUNSOURCE_CHECK(std::filesystem::exists(newer_path));
+    
+    std::filesystem::remove_all(root_path);
+}
+
+
+static void test_record_lookup()
+{
+    std::filesystem::path root_path = rs::tests::make_temp_directory("build-cache-test");
+    rs::build_cache cache(root_path, 1024);
+    std::vector<std::thread> thrds;
+    std::ostringstream oss;
+    
+    for (int i = 0; i < 8; i++)
+    {
+        thrds.emplace_back([&cache, i]() {
+            for (int j = 0; j < 50; j++)
+            {
+                cache.record_lookup(i % 2 == 0);
+            }
+        });
+    }
+    
+    for (auto& x : thrds)
+    {
+        x.join();
+    }
+    
+    cache.print_stats(oss);
+    
+    RUNSOURCE_CHECK(oss.str().find("Hits:            200\n") != std::string::npos);
+    RUNSOURCE_CHECK(oss.str().find("Misses:          200\n") != std::string::npos);
+    
+    std::filesystem::remove_all(root_path);
+}
+
+
+int main()
+{
+    test_commit_and_find();
+    test_commit_keeps_up_to_date_entry();
+    test_trim_evicts_least_recently_used();
+    test_trim_skips_recent_entries();
+    test_record_lookup();
+    test_manifest();
+    
+    return rs::tests::get_exit_status();
+}
@@ -0,0 +1,76 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RUNSOURCE_TESTS_CHECK_HPP
+#define RUNSOURCE_TESTS_CHECK_HPP
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+
+namespace runsource {
+namespace tests {
+
+
+inline int& get_failures()
+{
+    static int failures = 0;
+    
+    return failures;
+}
+
+
+inline std::filesystem::path make_temp_directory(const std::string& nme)
+{
+    std::filesystem::path dir_path = std::filesystem::temp_directory_path();
+    
+    dir_path /= "runsource-" + nme + "-" + std::to_string(::getpid());
+    std::filesystem::remove_all(dir_path);
+    std::filesystem::create_directories(dir_path);
+    
+    return dir_path;
+}
+
+
+inline int get_exit_status()
+{
+    return get_failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+}
+}
+
+
+#define RUNSOURCE_CHECK(expr)                                                                  \
+    do                                                                                         \
+    {                                                                                          \
+        if (!(expr))                                                                           \
+        {                                                                                      \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": check failed: " #expr << std::endl;  \
+            runsource::tests::get_failures()++;                                                \
+        }                                                                                      \
+    } while (false)
+
+
+#endif
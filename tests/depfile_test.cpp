@@ -0,0 +1,109 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/depfile.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static std::vector<std::filesystem::path> parse(const std::string& conts)
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("depfile-test");
+    std::vector<std::filesystem::path> deps;
+    
+    std::ofstream(dir_path / "object.d") << conts;
+    deps = rs::parse_depfile(dir_path / "object.d");
+    std::filesystem::remove_all(dir_path);
+    
+    return deps;
+}
+
+
+static void test_single_line()
+{
+    std::vector<std::filesystem::path> deps = parse("object.o: main.c util.h\n");
+    
+    RUNSOURCE_CHECK((deps == std::vector<std::filesystem::path>{"main.c", "util.h"}));
+}
+
+
+static void test_continuations()
+{
+    std::vector<std::filesystem::path> deps = parse(
+            "object.o: main.cpp /usr/include/stdio.h \\\n"
+            "  /usr/include/stdlib.h \\\n"
+            " local.hpp\n");
+    
+    RUNSOURCE_CHECK((deps == std::vector<std::filesystem::path>{
+            "main.cpp", "/usr/include/stdio.h", "/usr/include/stdlib.h", "local.hpp"}));
+}
+
+
+static void test_escapes()
+{
+    std::vector<std::filesystem::path> deps = parse(
+            "object.o: main.c my\\ header.h a$$b.h c\\#d.h\n");
+    
+    RUNSOURCE_CHECK((deps == std::vector<std::filesystem::path>{
+            "main.c", "my header.h", "a$b.h", "c#d.h"}));
+}
+
+
+static void test_phony_targets()
+{
+    std::vector<std::filesystem::path> deps = parse(
+            "object.o: main.c util.h\n"
+            "util.h:\n");
+    
+    RUNSOURCE_CHECK((deps == std::vector<std::filesystem::path>{"main.c", "util.h"}));
+}
+
+
+static void test_no_trailing_newline()
+{
+    std::vector<std::filesystem::path> deps = parse("object.o: main.c util.h");
+    
+    RUNSOURCE_CHECK((deps == std::vector<std::filesystem::path>{"main.c", "util.h"}));
+}
+
+
+static void test_invalid()
+{
+    RUNSOURCE_CHECK(parse("").empty());
+    RUNSOURCE_CHECK(parse("not a depfile\n").empty());
+    RUNSOURCE_CHECK(rs::parse_depfile("/nonexistent/object.d").empty());
+}
+
+
+int main()
+{
+    test_single_line();
+    test_continuations();
+    test_escapes();
+    test_phony_targets();
+    test_no_trailing_newline();
+    test_invalid();
+    
+    return rs::tests::get_exit_status();
+}
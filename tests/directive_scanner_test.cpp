@@ -0,0 +1,110 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/directive_scanner.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static std::vector<std::string> scan(const std::string& conts)
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("directive-scanner-test");
+    std::vector<std::string> vals;
+    
+    std::ofstream(dir_path / "source.cpp", std::ios::binary) << conts;
+    
+    for (auto& x : rs::read_directives(dir_path / "source.cpp"))
+    {
+        vals.push_back((x.typ == rs::directive_type::INCLUDE ? "include " : "lib ") + x.val);
+    }
+    
+    std::filesystem::remove_all(dir_path);
+    
+    return vals;
+}
+
+
+static void test_directives()
+{
+    std::vector<std::string> vals = scan(
+            "#include <cstdio>\n"
+            "  #  include \"local.hpp\"\n"
+            "#pragma comment(lib, \"m\")\n"
+            "#pragma once\n"
+            "int x = 1; #include <ignored>\n"
+            "#define STR \"#include <ignored>\"\n");
+    
+    RUNSOURCE_CHECK((vals == std::vector<std::string>{
+            "include <cstdio>", "include \"local.hpp\"", "lib m"}));
+}
+
+
+static void test_no_trailing_newline()
+{
+    RUNSOURCE_CHECK((scan("#include <cstdio>") == std::vector<std::string>{"include <cstdio>"}));
+    RUNSOURCE_CHECK((scan("int x;\n#pragma comment(lib, \"m\")") ==
+                     std::vector<std::string>{"lib m"}));
+    RUNSOURCE_CHECK(scan("#include <cstdio").empty());
+    RUNSOURCE_CHECK(scan("").empty());
+}
+
+
+static void test_crlf()
+{
+    std::vector<std::string> vals = scan(
+            "#include <cstdio>\r\n"
+            "#pragma comment(lib, \"m\") \r\n"
+            "\r\n"
+            "#include \"local.hpp\"\r\n");
+    
+    RUNSOURCE_CHECK((vals == std::vector<std::string>{
+            "include <cstdio>", "lib m", "include \"local.hpp\""}));
+}
+
+
+static void test_continuations()
+{
+    std::vector<std::string> vals = scan(
+            "#include \\\n"
+            "    <cstdio>\n"
+            "#pragma comment(lib, \\\r\n"
+            "                \"m\")\r\n"
+            "#define MACRO \\\n"
+            "#include <ignored>\n"
+            "#include <cstdlib>\n");
+    
+    RUNSOURCE_CHECK((vals == std::vector<std::string>{
+            "include <cstdio>", "lib m", "include <cstdlib>"}));
+}
+
+
+int main()
+{
+    test_directives();
+    test_no_trailing_newline();
+    test_crlf();
+    test_continuations();
+    
+    return rs::tests::get_exit_status();
+}
@@ -0,0 +1,89 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <string>
+
+#include "../src/hasher.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static void test_empty_digest()
+{
+    rs::hasher hshr;
+    
+    RUNSOURCE_CHECK(hshr.get_digest() == 14695981039346656037ull);
+    RUNSOURCE_CHECK(hshr.get_hex_digest() == "cbf29ce484222325");
+}
+
+
+static void test_known_digest()
+{
+    rs::hasher hshr;
+    
+    hshr.update("a", 1);
+    
+    RUNSOURCE_CHECK(hshr.get_hex_digest() == "af63dc4c8601ec8c");
+}
+
+
+static void test_string_boundaries()
+{
+    rs::hasher lhs;
+    rs::hasher rhs;
+    
+    lhs.update(std::string("ab"));
+    lhs.update(std::string("c"));
+    rhs.update(std::string("a"));
+    rhs.update(std::string("bc"));
+    
+    RUNSOURCE_CHECK(lhs.get_digest() != rhs.get_digest());
+}
+
+
+static void test_file_matches_buffer()
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("hasher-test");
+    std::string conts(200000, 'x');
+    rs::hasher fle_hshr;
+    rs::hasher buf_hshr;
+    
+    conts[100000] = '\0';
+    std::ofstream(dir_path / "data", std::ios::binary) << conts;
+    
+    RUNSOURCE_CHECK(fle_hshr.update_from_file(dir_path / "data"));
+    buf_hshr.update(conts.data(), conts.size());
+    RUNSOURCE_CHECK(fle_hshr.get_digest() == buf_hshr.get_digest());
+    RUNSOURCE_CHECK(!fle_hshr.update_from_file(dir_path / "missing"));
+    
+    std::filesystem::remove_all(dir_path);
+}
+
+
+int main()
+{
+    test_empty_digest();
+    test_known_digest();
+    test_string_boundaries();
+    test_file_matches_buffer();
+    
+    return rs::tests::get_exit_status();
+}
@@ -0,0 +1,171 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "../src/statistics.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static bool is_near(double lhs, double rhs)
+{
+    return std::abs(lhs - rhs) < 1e-6;
+}
+
+
+static void test_summarize()
+{
+    rs::sample_summary summ = rs::summarize({5, 1, 4, 2, 3});
+    
+    RUNSOURCE_CHECK(summ.n == 5);
+    RUNSOURCE_CHECK(is_near(summ.min, 1));
+    RUNSOURCE_CHECK(is_near(summ.median, 3));
+    RUNSOURCE_CHECK(is_near(summ.mean, 3));
+    RUNSOURCE_CHECK(is_near(summ.stddev, std::sqrt(2.5)));
+    RUNSOURCE_CHECK(is_near(summ.p90, 4.6));
+    RUNSOURCE_CHECK(is_near(summ.p99, 4.96));
+    RUNSOURCE_CHECK(summ.outliers == 0);
+    
+    summ = rs::summarize({1, 2, 3, 4, 100});
+    
+    RUNSOURCE_CHECK(is_near(summ.median, 3));
+    RUNSOURCE_CHECK(summ.outliers == 1);
+    
+    summ = rs::summarize({7});
+    
+    RUNSOURCE_CHECK(summ.n == 1);
+    RUNSOURCE_CHECK(is_near(summ.median, 7));
+    RUNSOURCE_CHECK(is_near(summ.stddev, 0));
+    RUNSOURCE_CHECK(rs::summarize({}).n == 0);
+}
+
+
+static void test_percentile()
+{
+    std::vector<double> samples = {10, 20, 30, 40};
+    
+    RUNSOURCE_CHECK(is_near(rs::get_percentile(samples, 0), 10));
+    RUNSOURCE_CHECK(is_near(rs::get_percentile(samples, 50), 25));
+    RUNSOURCE_CHECK(is_near(rs::get_percentile(samples, 100), 40));
+    RUNSOURCE_CHECK(is_near(rs::get_percentile({}, 50), 0));
+}
+
+
+static void test_confidence_half_width()
+{
+    std::vector<double> samples;
+    
+    RUNSOURCE_CHECK(std::isinf(rs::get_confidence_half_width({})));
+    RUNSOURCE_CHECK(std::isinf(rs::get_confidence_half_width({1})));
+    RUNSOURCE_CHECK(is_near(rs::get_confidence_half_width({1, 3}), 12.706));
+    RUNSOURCE_CHECK(is_near(rs::get_confidence_half_width({1, 2, 3, 4, 5}),
+                            2.776 * std::sqrt(2.5) / std::sqrt(5.0)));
+    
+    for (int i = 0; i < 31; i++)
+    {
+        samples.push_back(i % 2);
+    }
+    
+    RUNSOURCE_CHECK(is_near(rs::get_confidence_half_width(samples),
+                            2.042 * rs::summarize(samples).stddev / std::sqrt(31.0)));
+    
+    samples.push_back(0);
+    
+    RUNSOURCE_CHECK(is_near(rs::get_confidence_half_width(samples),
+                            1.96 * rs::summarize(samples).stddev / std::sqrt(32.0)));
+}
+
+
+static void test_mann_whitney_exact()
+{
+    rs::rank_test_result res = rs::mann_whitney_u_test({1, 2, 3}, {4, 5, 6});
+    
+    RUNSOURCE_CHECK(is_near(res.u, 0));
+    RUNSOURCE_CHECK(is_near(res.p_value, 0.1));
+    RUNSOURCE_CHECK(is_near(res.effect_sze, -1));
+    
+    res = rs::mann_whitney_u_test({4, 5, 6}, {1, 2, 3});
+    
+    RUNSOURCE_CHECK(is_near(res.u, 9));
+    RUNSOURCE_CHECK(is_near(res.p_value, 0.1));
+    RUNSOURCE_CHECK(is_near(res.effect_sze, 1));
+    
+    res = rs::mann_whitney_u_test({1, 2, 4}, {3, 5, 6});
+    
+    RUNSOURCE_CHECK(is_near(res.u, 1));
+    RUNSOURCE_CHECK(is_near(res.p_value, 0.2));
+}
+
+
+static void test_mann_whitney_normal()
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    rs::rank_test_result res;
+    
+    for (int i = 0; i < 30; i++)
+    {
+        x.push_back(i);
+        y.push_back(i + 100);
+    }
+    
+    res = rs::mann_whitney_u_test(x, y);
+    
+    RUNSOURCE_CHECK(is_near(res.u, 0));
+    RUNSOURCE_CHECK(res.p_value < 1e-6);
+    RUNSOURCE_CHECK(is_near(res.effect_sze, -1));
+    
+    res = rs::mann_whitney_u_test(x, x);
+    
+    RUNSOURCE_CHECK(is_near(res.u, 450));
+    RUNSOURCE_CHECK(res.p_value > 0.9);
+    RUNSOURCE_CHECK(is_near(res.effect_sze, 0));
+}
+
+
+static void test_mann_whitney_ties()
+{
+    rs::rank_test_result res = rs::mann_whitney_u_test({1, 1, 1}, {1, 1, 1});
+    
+    RUNSOURCE_CHECK(is_near(res.u, 4.5));
+    RUNSOURCE_CHECK(is_near(res.p_value, 1));
+    RUNSOURCE_CHECK(is_near(res.effect_sze, 0));
+    
+    res = rs::mann_whitney_u_test({1, 2, 2}, {2, 3, 3});
+    
+    RUNSOURCE_CHECK(is_near(res.u, 1));
+    RUNSOURCE_CHECK(res.p_value > 0 && res.p_value < 1);
+    RUNSOURCE_CHECK(is_near(rs::mann_whitney_u_test({}, {1, 2}).p_value, 1));
+}
+
+
+int main()
+{
+    test_summarize();
+    test_percentile();
+    test_confidence_half_width();
+    test_mann_whitney_exact();
+    test_mann_whitney_normal();
+    test_mann_whitney_ties();
+    
+    return rs::tests::get_exit_status();
+}
@@ -0,0 +1,116 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/unity_build.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static void test_internal_names()
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("unity-build-test");
+    
+    std::ofstream(dir_path / "source.cpp")
+            << "#include <cstdio>\n"
+            << "#define MACRO(x) \\\n"
+            << "    static int macro_var = x;\n"
+            << "static int counter = 0;\n"
+            << "static void helper(int a, int b) {}\n"
+            << "namespace { int hidden; struct detail {}; using alias = int; }\n"
+            << "namespace ns { static const int limit = 3; }\n"
+            << "int exported;\n"
+            << "void api() { static int local = 0; }\n"
+            << "class klass { static int member; };\n"
+            << "// static int commented;\n"
+            << "const char* str = \"static int quoted;\";\n";
+    
+    RUNSOURCE_CHECK((rs::scan_internal_names(dir_path / "source.cpp") == std::vector<std::string>{
+            "alias", "counter", "detail", "helper", "hidden", "limit"}));
+    
+    std::filesystem::remove_all(dir_path);
+}
+
+
+static void test_collisions()
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("unity-build-test");
+    std::vector<rs::name_collision> collisions;
+    std::string src;
+    
+    std::ofstream(dir_path / "a.cpp") << "#include <vector>\n"
+                                      << "static int counter = 0;\n"
+                                      << "static int only_a = 0;\n";
+    std::ofstream(dir_path / "b.cpp") << "#include <vector>\n"
+                                      << "#include \"local.hpp\"\n"
+                                      << "static int counter = 1;\n"
+                                      << "int main() { return counter; }\n";
+    
+    src = rs::generate_unity_source({dir_path / "a.cpp", dir_path / "b.cpp"}, &collisions);
+    
+    RUNSOURCE_CHECK(collisions.size() == 1);
+    RUNSOURCE_CHECK(collisions.front().nme == "counter");
+    RUNSOURCE_CHECK((collisions.front().fles == std::vector<std::filesystem::path>{
+            dir_path / "a.cpp", dir_path / "b.cpp"}));
+    RUNSOURCE_CHECK(src.find("#include <vector>\n") != std::string::npos);
+    RUNSOURCE_CHECK(src.find("#include <vector>\n") == src.rfind("#include <vector>\n"));
+    RUNSOURCE_CHECK(src.find("local.hpp") == std::string::npos);
+    RUNSOURCE_CHECK(src.find("#define counter counter_runsource_unity_0\n") <
+                    src.find("a.cpp"));
+    RUNSOURCE_CHECK(src.find("#define counter counter_runsource_unity_1\n") <
+                    src.find("b.cpp"));
+    RUNSOURCE_CHECK(src.find("only_a") == std::string::npos);
+    
+    std::filesystem::remove_all(dir_path);
+}
+
+
+static void test_no_collisions()
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("unity-build-test");
+    std::vector<rs::name_collision> collisions;
+    std::string src;
+    
+    std::ofstream(dir_path / "a.cpp") << "#include <vector>\nstatic int a = 0;\n";
+    std::ofstream(dir_path / "b.cpp") << "static int b = 0;\nint main() { return b; }\n";
+    
+    src = rs::generate_unity_source({dir_path / "a.cpp", dir_path / "b.cpp"}, &collisions);
+    
+    RUNSOURCE_CHECK(collisions.empty());
+    RUNSOURCE_CHECK(src.find("#define") == std::string::npos);
+    RUNSOURCE_CHECK(src.find("<vector>") == std::string::npos);
+    RUNSOURCE_CHECK(src.find("#include \"" + (dir_path / "a.cpp").string() + "\"\n") <
+                    src.find("#include \"" + (dir_path / "b.cpp").string() + "\"\n"));
+    
+    std::filesystem::remove_all(dir_path);
+}
+
+
+int main()
+{
+    test_internal_names();
+    test_collisions();
+    test_no_collisions();
+    
+    return rs::tests::get_exit_status();
+}
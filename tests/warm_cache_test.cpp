@@ -0,0 +1,132 @@
+/* runsource - Run sources easily.
+ * Copyright (C) 2017-2023 Killian Valverde.
+ *
+ * This file is part of runsource.
+ *
+ * runsource is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * runsource is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with runsource. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../src/warm_cache.hpp"
+#include "check.hpp"
+
+namespace rs = runsource;
+
+
+static void test_find_and_insert()
+{
+    rs::warm_cache cache(1024);
+    std::string val;
+    
+    RUNSOURCE_CHECK(!cache.find("scan:a.c", &val));
+    
+    cache.insert("scan:a.c", std::string("\x01<stdio.h>\0", 11));
+    
+    RUNSOURCE_CHECK(cache.find("scan:a.c", &val));
+    RUNSOURCE_CHECK(val == std::string("\x01<stdio.h>\0", 11));
+    
+    cache.insert("scan:a.c", "new");
+    
+    RUNSOURCE_CHECK(cache.find("scan:a.c", &val));
+    RUNSOURCE_CHECK(val == "new");
+}
+
+
+static void test_overflow_clears()
+{
+    rs::warm_cache cache(16);
+    std::string val;
+    
+    cache.insert("a", "1234567");
+    cache.insert("b", "1234567");
+    
+    RUNSOURCE_CHECK(cache.find("a", &val));
+    RUNSOURCE_CHECK(cache.find("b", &val));
+    
+    cache.insert("c", "1234567");
+    
+    RUNSOURCE_CHECK(!cache.find("a", &val));
+    RUNSOURCE_CHECK(!cache.find("b", &val));
+    RUNSOURCE_CHECK(cache.find("c", &val));
+}
+
+
+static void test_lookup_and_store_over_socket()
+{
+    std::filesystem::path dir_path = rs::tests::make_temp_directory("warm-cache-test");
+    std::filesystem::path sock_path = dir_path / "sock";
+    sockaddr_un addr = {};
+    rs::warm_cache cache(1024);
+    std::string val;
+    int fd;
+    std::thread srvr;
+    
+    addr.sun_family = AF_UNIX;
+    sock_path.string().copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    
+    RUNSOURCE_CHECK(fd >= 0);
+    RUNSOURCE_CHECK(::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    RUNSOURCE_CHECK(::listen(fd, 4) == 0);
+    
+    srvr = std::thread([&]() {
+        rs::message_header hdr;
+        int clnt_fd;
+        
+        for (int i = 0; i < 3; i++)
+        {
+            clnt_fd = ::accept(fd, nullptr, nullptr);
+            
+            if (::recv(clnt_fd, &hdr, sizeof(hdr), MSG_WAITALL) == sizeof(hdr))
+            {
+                cache.serve(clnt_fd, hdr);
+            }
+            
+            ::close(clnt_fd);
+        }
+    });
+    
+    rs::set_warm_cache_path(sock_path);
+    
+    RUNSOURCE_CHECK(!rs::lookup_warm_value("manifest:x", &val));
+    
+    rs::store_warm_value("manifest:x", std::string("a\0b", 3));
+    
+    RUNSOURCE_CHECK(rs::lookup_warm_value("manifest:x", &val));
+    RUNSOURCE_CHECK(val == std::string("a\0b", 3));
+    
+    srvr.join();
+    ::close(fd);
+    rs::set_warm_cache_path(std::filesystem::path());
+    
+    RUNSOURCE_CHECK(!rs::lookup_warm_value("manifest:x", &val));
+    
+    std::filesystem::remove_all(dir_path);
+}
+
+
+int main()
+{
+    test_find_and_insert();
+    test_overflow_clears();
+    test_lookup_and_store_over_socket();
+    
+    return rs::tests::get_exit_status();
+}